@@ -0,0 +1,254 @@
+#include "background_writer.h"
+
+#include "cata_utility.h"
+#include "debug.h"
+#include "filesystem.h"
+#include "mapsharing.h"
+#include "output.h"
+#include "translations.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+#define dbg(x) DebugLog((DebugLevel)(x),D_MAIN) << __FILE__ << ":" << __LINE__ << ": "
+
+namespace
+{
+
+struct write_job {
+    std::string path;
+    std::string contents;
+    std::string fail_message;
+    /** Remove the file instead of writing it, contents are ignored. */
+    bool remove;
+};
+
+class writer_thread
+{
+    public:
+        ~writer_thread() {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                stopping = true;
+            }
+            wake_worker.notify_all();
+            if( worker.joinable() ) {
+                worker.join();
+            }
+        }
+
+        void enqueue( write_job job ) {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                if( !worker.joinable() ) {
+                    worker = std::thread( &writer_thread::run, this );
+                }
+                queue.push_back( std::move( job ) );
+            }
+            wake_worker.notify_one();
+        }
+
+        void wait_until( const std::function<bool()> &done ) {
+            std::unique_lock<std::mutex> lock( mutex );
+            job_done.wait( lock, done );
+        }
+
+        bool is_pending( const std::string &path ) const {
+            if( current_path == path ) {
+                return true;
+            }
+            for( const write_job &job : queue ) {
+                if( job.path == path ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int count_pending() {
+            std::lock_guard<std::mutex> lock( mutex );
+            return queue.size() + ( current_path.empty() ? 0 : 1 );
+        }
+
+        std::vector<std::string> take_failures() {
+            std::lock_guard<std::mutex> lock( mutex );
+            std::vector<std::string> result;
+            result.swap( failures );
+            return result;
+        }
+
+        std::mutex mutex;
+        std::deque<write_job> queue;
+        /** Path of the job that is currently being written by the worker, empty if idle. */
+        std::string current_path;
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock( mutex );
+            while( true ) {
+                wake_worker.wait( lock, [this]() {
+                    return stopping || !queue.empty();
+                } );
+                if( queue.empty() ) {
+                    // Only stop once everything has been written.
+                    return;
+                }
+                write_job job = std::move( queue.front() );
+                queue.pop_front();
+                current_path = job.path;
+
+                lock.unlock();
+                std::string error = write( job );
+                lock.lock();
+
+                if( !error.empty() ) {
+                    failures.push_back( string_format( _( "Failed to write %1$s to \"%2$s\": %3$s" ),
+                                                       job.fail_message.c_str(), job.path.c_str(), error.c_str() ) );
+                }
+                current_path.clear();
+                job_done.notify_all();
+            }
+        }
+
+        /** Does the actual I/O, returns an error description or an empty string on success. */
+        static std::string write( const write_job &job ) {
+            if( job.remove ) {
+                if( file_exist( job.path ) && !remove_file( job.path ) ) {
+                    return "removing file failed";
+                }
+                return std::string();
+            }
+            const size_t separator = job.path.find_last_of( "/\\" );
+            if( separator != std::string::npos && !assure_dir_exist( job.path.substr( 0, separator ) ) ) {
+                return "creating directory failed";
+            }
+            // Write everything to a temporary file and replace the target only once that worked,
+            // so the previous save stays intact if anything goes wrong.
+            const std::string temp_path = job.path + ".temp";
+            {
+                std::ofstream fout( temp_path, std::ios::binary );
+                if( !fout.is_open() ) {
+                    return "opening file failed";
+                }
+                fout.write( job.contents.data(), job.contents.size() );
+                fout.close();
+                if( fout.fail() ) {
+                    remove_file( temp_path );
+                    return "writing to file failed";
+                }
+            }
+            if( !rename_file( temp_path, job.path ) ) {
+                remove_file( temp_path );
+                return "renaming file failed";
+            }
+            return std::string();
+        }
+
+        std::thread worker;
+        std::condition_variable wake_worker;
+        std::condition_variable job_done;
+        std::vector<std::string> failures;
+        bool stopping = false;
+};
+
+writer_thread &get_writer()
+{
+    static writer_thread instance;
+    return instance;
+}
+
+int deferred_scopes = 0;
+
+} // namespace
+
+namespace background_writer
+{
+
+deferred_scope::deferred_scope()
+{
+    deferred_scopes++;
+}
+
+deferred_scope::~deferred_scope()
+{
+    deferred_scopes--;
+}
+
+bool is_deferring()
+{
+    // Shared maps rely on the lock files of the exclusive I/O functions, those must stay synchronous.
+    return deferred_scopes > 0 && !MAP_SHARING::isSharing();
+}
+
+void flush()
+{
+    writer_thread &writer = get_writer();
+    writer.wait_until( [&writer]() {
+        return writer.queue.empty() && writer.current_path.empty();
+    } );
+    report_failures();
+}
+
+void wait_for( const std::string &path )
+{
+    writer_thread &writer = get_writer();
+    writer.wait_until( [&writer, &path]() {
+        return !writer.is_pending( path );
+    } );
+}
+
+int pending()
+{
+    return get_writer().count_pending();
+}
+
+void report_failures()
+{
+    for( const std::string &failure : get_writer().take_failures() ) {
+        dbg( D_ERROR ) << failure;
+        popup( "%s", failure.c_str() );
+    }
+}
+
+}
+
+bool write_to_file_deferred( const std::string &path,
+                             const std::function<void( std::ostream & )> &writer, const char *const fail_message )
+{
+    if( !background_writer::is_deferring() ) {
+        // An older deferred version of the file must not overwrite this one later.
+        background_writer::wait_for( path );
+        return write_to_file_exclusive( path, writer, fail_message );
+    }
+
+    std::ostringstream buffer;
+    try {
+        writer( buffer );
+    } catch( const std::exception &err ) {
+        if( fail_message ) {
+            popup( _( "Failed to write %1$s to \"%2$s\": %3$s" ), fail_message, path.c_str(), err.what() );
+        }
+        return false;
+    }
+    get_writer().enqueue( write_job{ path, buffer.str(), fail_message ? fail_message : _( "data" ), false } );
+    return true;
+}
+
+void remove_file_deferred( const std::string &path )
+{
+    if( background_writer::is_deferring() ) {
+        get_writer().enqueue( write_job{ path, std::string(), _( "data" ), true } );
+        return;
+    }
+    background_writer::wait_for( path );
+    if( file_exist( path ) ) {
+        remove_file( path );
+    }
+}
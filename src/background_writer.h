@@ -0,0 +1,71 @@
+#ifndef BACKGROUND_WRITER_H
+#define BACKGROUND_WRITER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+/**
+ * Moves the file I/O of saving off the main thread.
+ *
+ * The data is always serialized on the calling (main) thread into a memory buffer, only
+ * the directory creation and the writing of the buffer happen on a background writer thread.
+ * Files are written to a temporary file first and then renamed over the target, so a file is
+ * either completely old or completely new, even if the game crashes meanwhile.
+ *
+ * Writes are only deferred while a @ref background_writer::deferred_scope is alive (e.g. during
+ * autosave). Otherwise @ref write_to_file_deferred behaves like @ref write_to_file_exclusive,
+ * except that it waits for any pending write to the same file first.
+ *
+ * Reading a file with @ref read_from_file and friends waits for any pending write of that file,
+ * so loading can never see a partially written or outdated file.
+ */
+namespace background_writer
+{
+
+/** While an instance exists, @ref write_to_file_deferred hands the writing to the writer thread. */
+class deferred_scope
+{
+    public:
+        deferred_scope();
+        ~deferred_scope();
+
+        deferred_scope( const deferred_scope & ) = delete;
+        deferred_scope &operator=( const deferred_scope & ) = delete;
+};
+
+/** Whether writes are currently being deferred. */
+bool is_deferring();
+
+/** Blocks until all queued writes are done, then reports failures (see @ref report_failures). */
+void flush();
+/** Blocks until there is no queued or running write of the given file. */
+void wait_for( const std::string &path );
+/** Number of files that are queued or being written. */
+int pending();
+
+/**
+ * Shows a popup for each deferred write that failed since the last call. Must be called
+ * from the main thread, failures can not be reported from the writer thread itself.
+ */
+void report_failures();
+
+}
+
+/**
+ * Like @ref write_to_file_exclusive, but the file I/O is done on the writer thread while
+ * a @ref background_writer::deferred_scope exists (the writer is still called immediately).
+ * A deferred write always returns true, its failure is reported later by
+ * @ref background_writer::report_failures.
+ * If the fail_message is null, no popup is shown upon (non-deferred) failure.
+ */
+bool write_to_file_deferred( const std::string &path,
+                             const std::function<void( std::ostream & )> &writer, const char *fail_message );
+
+/**
+ * Removes the file if it exists. While a @ref background_writer::deferred_scope exists, the
+ * removal is queued behind the pending writes, so it can't be undone by an older write.
+ */
+void remove_file_deferred( const std::string &path );
+
+#endif
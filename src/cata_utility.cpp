@@ -12,6 +12,7 @@
 #include "json.h"
 #include "filesystem.h"
 #include "item_search.h"
+#include "background_writer.h"
 
 #include <algorithm>
 #include <cmath>
@@ -483,6 +484,7 @@ bool write_to_file_exclusive( const std::string &path,
 
 bool read_from_file( const std::string &path, const std::function<void( std::istream & )> &reader )
 {
+    background_writer::wait_for( path );
     try {
         std::ifstream fin( path, std::ios::binary );
         if( !fin ) {
@@ -521,6 +523,7 @@ bool read_from_file_optional( const std::string &path,
     // Note: slight race condition here, but we'll ignore it. Worst case: the file
     // exists and got removed before reading it -> reading fails with a message
     // Or file does not exists, than everything works fine because it's optional anyway.
+    background_writer::wait_for( path );
     return file_exist( path ) && read_from_file( path, reader );
 }
 
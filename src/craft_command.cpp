@@ -42,7 +42,7 @@ void craft_command::execute()
 
     bool need_selections = true;
     inventory map_inv;
-    map_inv.form_from_map( crafter->pos(), PICKUP_RANGE );
+    map_inv.form_index_from_map( crafter->pos(), PICKUP_RANGE );
 
     if( has_cached_selections() ) {
         std::vector<comp_selection<item_comp>> missing_items = check_item_components_missing( map_inv );
@@ -140,7 +140,7 @@ std::list<item> craft_command::consume_components()
     }
 
     inventory map_inv;
-    map_inv.form_from_map( crafter->pos(), PICKUP_RANGE );
+    map_inv.form_index_from_map( crafter->pos(), PICKUP_RANGE );
 
     if( !check_item_components_missing( map_inv ).empty() ) {
         debugmsg( "Aborting crafting: couldn't find cached components" );
@@ -265,7 +265,7 @@ const inventory &player::crafting_inventory()
         && cached_position == pos() ) {
         return cached_crafting_inventory;
     }
-    cached_crafting_inventory.form_from_map( pos(), PICKUP_RANGE, false );
+    cached_crafting_inventory.form_index_from_map( pos(), PICKUP_RANGE );
     cached_crafting_inventory += inv;
     cached_crafting_inventory += weapon;
     cached_crafting_inventory += worn;
@@ -278,6 +278,9 @@ const inventory &player::crafting_inventory()
         }
     }
 
+    // The crafting menu checks every known recipe against this inventory.
+    cached_crafting_inventory.build_index();
+
     cached_moves = moves;
     cached_turn = calendar::turn.get_turn();
     cached_position = pos();
@@ -289,6 +292,12 @@ void player::invalidate_crafting_inventory()
     cached_turn = -1;
 }
 
+recipe_availability &player::crafting_availability()
+{
+    cached_crafting_availability.update( crafting_inventory(), has_trait( "DEBUG_HS" ) );
+    return cached_crafting_availability;
+}
+
 int recipe::batch_time( int batch ) const
 {
     // 1.0f is full speed
@@ -914,7 +923,7 @@ to consume_items */
 std::list<item> player::consume_items( const std::vector<item_comp> &components, int batch )
 {
     inventory map_inv;
-    map_inv.form_from_map( pos(), PICKUP_RANGE );
+    map_inv.form_index_from_map( pos(), PICKUP_RANGE );
     return consume_items( select_item_component( components, batch, map_inv ), batch );
 }
 
@@ -1025,7 +1034,7 @@ void player::consume_tools( const std::vector<tool_comp> &tools, int batch,
                             const std::string &hotkeys )
 {
     inventory map_inv;
-    map_inv.form_from_map( pos(), PICKUP_RANGE );
+    map_inv.form_index_from_map( pos(), PICKUP_RANGE );
     consume_tools( select_tool_component( tools, batch, map_inv, hotkeys ), batch );
 }
 
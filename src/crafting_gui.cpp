@@ -176,7 +176,7 @@ const recipe *select_crafting_recipe( int &batch_size )
     std::string filterstring = "";
 
     const auto &available_recipes = g->u.get_available_recipes( crafting_inv, &helpers );
-    std::map<const recipe *, bool> availability_cache;
+    recipe_availability &availability = g->u.crafting_availability();
 
     do {
         if( redraw ) {
@@ -204,6 +204,7 @@ const recipe *select_crafting_recipe( int &batch_size )
                     current.push_back( chosen );
                     available.push_back( chosen->requirements().can_make_with_inventory( crafting_inv, i ) );
                 }
+                availability.forget( chosen );
             } else {
                 if( filterstring.empty() ) {
                     current = available_recipes.in_category( tab.cur(), subtab.cur() != "CSC_ALL" ? subtab.cur() : "" );
@@ -239,24 +240,18 @@ const recipe *select_crafting_recipe( int &batch_size )
                     }
                 }
                 available.reserve( current.size() );
-                // cache recipe availability on first display
-                for( const auto e : current ) {
-                    if( !availability_cache.count( e ) ) {
-                        availability_cache.emplace( e, e->requirements().can_make_with_inventory( crafting_inv ) );
-                    }
-                }
 
                 std::stable_sort( current.begin(), current.end(), []( const recipe * a, const recipe * b ) {
                     return b->difficulty < a->difficulty;
                 } );
 
                 std::stable_sort( current.begin(), current.end(), [&]( const recipe * a, const recipe * b ) {
-                    return availability_cache[a] && !availability_cache[b];
+                    return availability.can_make( a, crafting_inv ) && !availability.can_make( b, crafting_inv );
                 } );
 
                 std::transform( current.begin(), current.end(),
                 std::back_inserter( available ), [&]( const recipe * e ) {
-                    return availability_cache[e];
+                    return availability.can_make( e, crafting_inv );
                 } );
             }
 
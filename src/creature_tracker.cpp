@@ -6,6 +6,8 @@
 #include "mtype.h"
 #include "item.h"
 
+#include <algorithm>
+
 Creature_tracker::Creature_tracker()
 {
 }
@@ -76,6 +78,7 @@ bool Creature_tracker::add( monster &critter )
     }
 
     monsters_by_location[critter.pos()] = monsters_list.size();
+    add_to_cell( critter.pos(), monsters_list.size() );
     monsters_list.push_back( new monster( critter ) );
     return true;
 }
@@ -88,6 +91,22 @@ size_t Creature_tracker::size() const
 bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_pos )
 {
     const auto old_pos = critter.pos();
+    // The monster moves there even if the checks below fail
+    if( cell_at( old_pos ) != cell_at( new_pos ) ) {
+        const auto loc_iter = monsters_by_location.find( old_pos );
+        size_t index = monsters_list.size();
+        if( loc_iter != monsters_by_location.end() && monsters_list[loc_iter->second] == &critter ) {
+            index = loc_iter->second;
+        } else {
+            // Dead monsters are not in monsters_by_location
+            index = std::find( monsters_list.begin(), monsters_list.end(), &critter ) - monsters_list.begin();
+        }
+        if( index < monsters_list.size() ) {
+            remove_from_cell( old_pos, index );
+            add_to_cell( new_pos, index );
+        }
+    }
+
     if( critter.is_dead() ) {
         // mon_at ignores dead critters anyway, changing their position in the
         // monsters_by_location map is useless.
@@ -157,6 +176,7 @@ void Creature_tracker::remove( const int idx )
 
     monster &m = *monsters_list[idx];
     remove_from_location_map( m );
+    remove_from_cell( m.pos(), idx );
 
     delete monsters_list[idx];
     monsters_list.erase( monsters_list.begin() + idx );
@@ -167,6 +187,13 @@ void Creature_tracker::remove( const int idx )
             --elem.second;
         }
     }
+    for( auto &elem : monsters_by_cell ) {
+        for( auto &index : elem.second ) {
+            if( index > ( size_t )idx ) {
+                --index;
+            }
+        }
+    }
 }
 
 void Creature_tracker::clear()
@@ -176,14 +203,17 @@ void Creature_tracker::clear()
     }
     monsters_list.clear();
     monsters_by_location.clear();
+    monsters_by_cell.clear();
 }
 
 void Creature_tracker::rebuild_cache()
 {
     monsters_by_location.clear();
+    monsters_by_cell.clear();
     for( size_t i = 0; i < monsters_list.size(); i++ ) {
         monster &critter = *monsters_list[i];
         monsters_by_location[critter.pos()] = i;
+        add_to_cell( critter.pos(), i );
     }
 }
 
@@ -215,8 +245,75 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     if( ok ) {
         monsters_by_location[first.pos()] = first_mdex;
         monsters_by_location[second.pos()] = second_mdex;
+        if( cell_at( first.pos() ) != cell_at( second.pos() ) ) {
+            remove_from_cell( second.pos(), first_mdex );
+            add_to_cell( first.pos(), first_mdex );
+            remove_from_cell( first.pos(), second_mdex );
+            add_to_cell( second.pos(), second_mdex );
+        }
     } else {
         // Try to avoid spamming error messages if something weird happens
         rebuild_cache();
     }
 }
+
+point Creature_tracker::cell_at( const tripoint &p )
+{
+    // Round towards negative infinity, monsters can be outside of the reality bubble
+    const auto cell_coord = []( const int v ) {
+        return v >= 0 ? v / cell_size : ( v + 1 ) / cell_size - 1;
+    };
+    return point( cell_coord( p.x ), cell_coord( p.y ) );
+}
+
+void Creature_tracker::add_to_cell( const tripoint &p, const size_t index )
+{
+    monsters_by_cell[cell_at( p )].push_back( index );
+}
+
+void Creature_tracker::remove_from_cell( const tripoint &p, const size_t index )
+{
+    const auto iter = monsters_by_cell.find( cell_at( p ) );
+    if( iter == monsters_by_cell.end() ) {
+        return;
+    }
+    auto &indices = iter->second;
+    indices.erase( std::remove( indices.begin(), indices.end(), index ), indices.end() );
+    if( indices.empty() ) {
+        monsters_by_cell.erase( iter );
+    }
+}
+
+std::vector<int> Creature_tracker::find_in_radius( const tripoint &center, const int radius ) const
+{
+    std::vector<int> result;
+    const point min_cell = cell_at( center - tripoint( radius, radius, 0 ) );
+    const point max_cell = cell_at( center + tripoint( radius, radius, 0 ) );
+    const size_t cells = size_t( max_cell.x - min_cell.x + 1 ) * size_t( max_cell.y - min_cell.y + 1 );
+    if( cells > monsters_list.size() ) {
+        // Checking all monsters is cheaper than looking up that many cells
+        for( size_t i = 0; i < monsters_list.size(); i++ ) {
+            const tripoint &p = monsters_list[i]->pos();
+            if( std::abs( p.x - center.x ) <= radius && std::abs( p.y - center.y ) <= radius ) {
+                result.push_back( i );
+            }
+        }
+        return result;
+    }
+    for( int x = min_cell.x; x <= max_cell.x; x++ ) {
+        for( int y = min_cell.y; y <= max_cell.y; y++ ) {
+            const auto iter = monsters_by_cell.find( point( x, y ) );
+            if( iter == monsters_by_cell.end() ) {
+                continue;
+            }
+            for( const size_t index : iter->second ) {
+                const tripoint &p = monsters_list[index]->pos();
+                if( std::abs( p.x - center.x ) <= radius && std::abs( p.y - center.y ) <= radius ) {
+                    result.push_back( index );
+                }
+            }
+        }
+    }
+    std::sort( result.begin(), result.end() );
+    return result;
+}
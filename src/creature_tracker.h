@@ -30,12 +30,29 @@ class Creature_tracker
         const std::vector<monster> &list() const;
         /** Swaps the positions of two monsters */
         void swap_positions( monster &first, monster &second );
+        /**
+         * Returns the indices of all monsters (dead ones included) whose x and y coordinates
+         * are at most `radius` away from those of `center`, on any z-level, in ascending order.
+         * Only looks at the monsters nearby, unlike a loop over all of them.
+         */
+        std::vector<int> find_in_radius( const tripoint &center, int radius ) const;
 
     private:
         std::vector<monster *> monsters_list;
         std::unordered_map<tripoint, size_t> monsters_by_location;
         /** Remove the monsters entry in @ref monsters_by_location */
         void remove_from_location_map( const monster &critter );
+
+        /** Side length of the cells of @ref monsters_by_cell. */
+        static constexpr int cell_size = 12;
+        /**
+         * Indices of all monsters by the cell (of cell_size x cell_size squares, covering all
+         * z-levels) they are in. Unlike @ref monsters_by_location, it also contains dead monsters.
+         */
+        std::unordered_map<point, std::vector<size_t>> monsters_by_cell;
+        static point cell_at( const tripoint &p );
+        void add_to_cell( const tripoint &p, size_t index );
+        void remove_from_cell( const tripoint &p, size_t index );
 };
 
 #endif
@@ -1769,6 +1769,7 @@ int editmap::mapgen_preview( real_coords &tc, uimenu &gmenu )
                             submap *srcsm = tmpmap.get_submap_at_grid( x, y, target.z );
                             destsm->is_uniform = false;
                             srcsm->is_uniform = false;
+                            destsm->is_dirty = true;
 
                             for( auto &v : destsm->vehicles ) {
                                 auto &ch = g->m.access_cache( v->smz );
@@ -1829,6 +1830,9 @@ int editmap::mapgen_preview( real_coords &tc, uimenu &gmenu )
                         }
                     }
                     g->m.reset_vehicle_cache( target.z );
+                    // Terrain, fields and items were copied without the map noticing.
+                    g->m.set_transparency_cache_dirty( target.z );
+                    g->m.set_outside_cache_dirty( target.z );
 
                     //~ message when applying the map generator
                     popup( _( "Changed 4 submaps\n%s" ), s.c_str() );
@@ -2005,6 +2009,6 @@ void editmap::cleartmpmap( tinymap &tmpmap )
 
     auto &ch = tmpmap.get_cache( target.z );
     std::memset( ch.veh_exists_at, 0, sizeof( ch.veh_exists_at ) );
-    ch.veh_cached_parts.clear();
+    ch.cached_vehicles.clear();
     ch.vehicle_list.clear();
 }
@@ -477,19 +477,22 @@ bool map::process_fields()
                 submap * const current_submap = get_submap_at_grid( x, y, z );
                 if( current_submap->field_count > 0 ) {
                     const bool cur_dirty = process_fields_in_submap( current_submap, x, y, z );
+                    if( cur_dirty ) {
+                        get_cache( z ).transparency_dirty_submaps.set( x + y * MAPSIZE );
+                    }
                     zlev_dirty |= cur_dirty;
                 }
             }
         }
 
         if( zlev_dirty ) {
-            // For now, just always dirty the transparency cache
-            // when a field might possibly be changed.
+            // For now, just always dirty the transparency cache of submaps
+            // where a field might possibly be changed (see above). Fields
+            // spreading to other submaps mark the tiles they change.
             // TODO: check if there are any fields(mostly fire)
             //       that frequently change, if so set the dirty
             //       flag, otherwise only set the dirty flag if
             //       something actually changed
-            set_transparency_cache_dirty( z );
             dirty_transparency_cache = true;
         }
     }
@@ -556,6 +559,12 @@ If you need to insert a new field behavior per unit time add a case statement in
 bool map::process_fields_in_submap( submap *const current_submap,
                                     const int submap_x, const int submap_y, const int submap_z )
 {
+    // This should be true only when the field changes transparency
+    // More correctly: not just when the field is opaque, but when it changes state
+    // to a more/less transparent one, or creates a non-transparent field nearby
+    // Fields changed on other tiles mark those tiles, they may be on other submaps.
+    bool dirty_transparency_cache = false;
+
     const auto get_neighbors = [this]( const tripoint &pt ) {
         // Wrapper to allow skipping bound checks except at the edges of the map
         const auto maptile_has_bounds = [this]( const tripoint &pt, const bool bounds_checked ) {
@@ -585,7 +594,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
         } };
     };
 
-    const auto spread_gas = [this, &get_neighbors] (
+    const auto spread_gas = [this, &get_neighbors, &dirty_transparency_cache] (
         field_entry *cur, const tripoint &p, field_id curtype,
         int percent_spread, int outdoor_age_speedup ) {
         // Reset nearby scents to zero
@@ -618,7 +627,10 @@ bool map::process_fields_in_submap( submap *const current_submap,
                 ( tmpfld == nullptr || tmpfld->getFieldDensity() < cur->getFieldDensity() );
         };
 
-        const auto spread_to = [&]( maptile &dst ) {
+        const auto spread_to = [&]( maptile &dst, const tripoint &dst_p ) {
+            if( dirty_transparency_cache ) {
+                set_transparency_cache_dirty( dst_p );
+            }
             field_entry *candidate_field = dst.find_field( curtype );
             // Nearby gas grows thicker, and ages are shared.
             int age_fraction = 0.5 + current_age / current_density;
@@ -641,7 +653,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
             tripoint down{p.x, p.y, p.z - 1};
             maptile down_tile = maptile_at_internal( down );
             if( can_spread_to( down_tile, curtype ) && valid_move( p, down, true, true ) ) {
-                spread_to( down_tile );
+                spread_to( down_tile, down );
                 return;
             }
         }
@@ -664,12 +676,13 @@ bool map::process_fields_in_submap( submap *const current_submap,
         // If not possible (or randomly), try to spread up
         if( !spread.empty() && ( !zlevels || one_in( spread.size() ) ) ) {
             // Construct the destination from offset and p
-            spread_to( neighs[ random_entry( spread ) ] );
+            const size_t i = random_entry( spread );
+            spread_to( neighs[ i ], offset_by_index( i, p ) );
         } else if( zlevels && p.z < OVERMAP_HEIGHT ) {
             tripoint up{p.x, p.y, p.z + 1};
             maptile up_tile = maptile_at_internal( up );
             if( can_spread_to( up_tile, curtype ) && valid_move( p, up, true, true ) ) {
-                spread_to( up_tile );
+                spread_to( up_tile, up );
             }
         }
     };
@@ -705,10 +718,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
         }
     };
 
-    // This should be true only when the field changes transparency
-    // More correctly: not just when the field is opaque, but when it changes state
-    // to a more/less transparent one, or creates a non-transparent field nearby
-    bool dirty_transparency_cache = false;
     //Holds m.field_at(x,y).findField(fd_some_field) type returns.
     // Just to avoid typing that long string for a temp value.
     field_entry *tmpfld = nullptr;
@@ -809,6 +818,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                 acid_there->setFieldDensity( new_density );
                                 acid_there->setFieldAge( new_age );
                             }
+                            set_transparency_cache_dirty( dst );
 
                             // Set ourselves up for removal
                             cur->setFieldDensity( 0 );
@@ -948,6 +958,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                 tripoint dst{p.x, p.y, p.z - 1};
                                 if( valid_move( p, dst, true, true ) ) {
                                     maptile dst_tile = maptile_at_internal( dst );
+                                    set_transparency_cache_dirty( dst );
                                     field_entry *fire_there = dst_tile.find_field( fd_fire );
                                     if( fire_there == nullptr ) {
                                         dst_tile.add_field( fd_fire, 1, 0 );
@@ -1015,6 +1026,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                         ( in_pit == ( dst.get_ter() == t_pit) ) ) {
                                         if( dstfld->getFieldDensity() < 2 ) {
                                             dstfld->setFieldDensity(dstfld->getFieldDensity() + 1);
+                                            set_transparency_cache_dirty( offset_by_index( i, p ) );
                                         }
 
                                         dstfld->setFieldAge( dstfld->getFieldAge() - MINUTES(5) );
@@ -1079,6 +1091,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                     nearfire->setFieldAge( nearfire->getFieldAge() - MINUTES(2) );
                                 } else {
                                     dst.add_field( fd_fire, 1, 0 );
+                                    set_transparency_cache_dirty( {p.x, p.y, p.z + 1} );
                                 }
                                 // Fueling fires above doesn't cost fuel
                             }
@@ -1126,6 +1139,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                     nearwebfld || ( dst.get_item_count() > 0 && flammable_items_at( offset_by_index( i, p ) ) && one_in(5) )
                                   ) ) {
                                 dst.add_field( fd_fire, 1, 0 ); // Nearby open flammable ground? Set it on fire.
+                                set_transparency_cache_dirty( offset_by_index( i, p ) );
                                 tmpfld = dst.find_field(fd_fire);
                                 if( tmpfld != nullptr ) {
                                     // Make the new fire quite weak, so that it doesn't start jumping around instantly
@@ -1150,6 +1164,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                     const auto &dst_ter = dst.get_ter_t();
                                     if( dst_ter.has_flag( TFLAG_NO_FLOOR ) ) {
                                         dst.add_field( fd_smoke, rng( 1, cur->getFieldDensity() ), 0 );
+                                        set_transparency_cache_dirty( up );
                                     } else {
                                         // Can't create smoke above
                                         smoke_up = false;
@@ -1287,6 +1302,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                 tmpfld = wandering_field.findField(fd_toxic_gas);
                                 if (tmpfld && tmpfld->getFieldDensity() < 3) {
                                     tmpfld->setFieldDensity(tmpfld->getFieldDensity() + 1);
+                                    set_transparency_cache_dirty( pnt );
                                 } else {
                                     add_field( pnt, fd_toxic_gas, 3, 0 );
                                 }
@@ -1354,6 +1370,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                     if( passable( dst ) && elec != nullptr &&
                                         elec->getFieldDensity() < 3) {
                                         elec->setFieldDensity( elec->getFieldDensity() + 1 );
+                                        set_transparency_cache_dirty( dst );
                                         cur->setFieldDensity(cur->getFieldDensity() - 1);
                                     } else if( passable( dst ) ) {
                                         add_field( dst, fd_electricity, 1, cur->getFieldAge() + 1 );
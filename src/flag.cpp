@@ -4,9 +4,72 @@
 
 #include <map>
 #include <algorithm>
+#include <deque>
+#include <unordered_map>
 
 std::map<std::string, json_flag> json_flags_all;
 
+/** Flags that are loaded with "inherit": false, all others are inherited. */
+static flag_set json_flags_not_inherited;
+
+namespace
+{
+
+/** Flag names by interned id, a deque so the names never move. */
+std::deque<std::string> &flag_names()
+{
+    static std::deque<std::string> names;
+    return names;
+}
+
+std::unordered_map<std::string, int> &flag_ids()
+{
+    static std::unordered_map<std::string, int> ids;
+    return ids;
+}
+
+}
+
+flag_set::flag_set( const std::set<std::string> &flags )
+{
+    for( const std::string &f : flags ) {
+        insert( id( f ) );
+    }
+}
+
+int flag_set::id( const std::string &flag )
+{
+    auto &ids = flag_ids();
+    const auto iter = ids.find( flag );
+    if( iter != ids.end() ) {
+        return iter->second;
+    }
+    flag_names().push_back( flag );
+    return ids.emplace( flag, ids.size() ).first->second;
+}
+
+const std::string &flag_set::name( const int flag )
+{
+    return flag_names()[flag];
+}
+
+void flag_set::insert( const int flag )
+{
+    const size_t word = flag / 64;
+    if( word >= bits.size() ) {
+        bits.resize( word + 1, 0 );
+    }
+    bits[word] |= uint64_t( 1 ) << ( flag % 64 );
+}
+
+void flag_set::erase( const int flag )
+{
+    const size_t word = flag / 64;
+    if( word < bits.size() ) {
+        bits[word] &= ~( uint64_t( 1 ) << ( flag % 64 ) );
+    }
+}
+
 const json_flag &json_flag::get( const std::string &id )
 {
     static json_flag null_flag;
@@ -22,6 +85,17 @@ void json_flag::load( JsonObject &jo )
     jo.read( "info", f.info_ );
     jo.read( "conflicts", f.conflicts_ );
     jo.read( "inherit", f.inherit_ );
+
+    if( f.inherit_ ) {
+        json_flags_not_inherited.erase( flag_set::id( id ) );
+    } else {
+        json_flags_not_inherited.insert( flag_set::id( id ) );
+    }
+}
+
+bool json_flag::inherit( const int flag )
+{
+    return !json_flags_not_inherited.count( flag );
 }
 
 void json_flag::check_consistency()
@@ -43,4 +117,5 @@ void json_flag::check_consistency()
 void json_flag::reset()
 {
     json_flags_all.clear();
+    json_flags_not_inherited = flag_set();
 }
@@ -4,6 +4,40 @@
 #include "json.h"
 
 #include <set>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Set of flags, stored as one bit per flag. Flag names are interned to small integers
+ * on first use. Those ids are never reset, so they stay valid for the whole run.
+ */
+class flag_set
+{
+    public:
+        flag_set() = default;
+        explicit flag_set( const std::set<std::string> &flags );
+
+        /** Interned id of the flag name, assigns a new one if needed. */
+        static int id( const std::string &flag );
+        /** Name of an interned flag. */
+        static const std::string &name( int flag );
+
+        void insert( int flag );
+        void erase( int flag );
+
+        bool count( const int flag ) const {
+            const size_t word = flag / 64;
+            return word < bits.size() && ( bits[word] >> ( flag % 64 ) & 1 );
+        }
+
+        bool empty() const {
+            return bits.empty();
+        }
+
+    private:
+        std::vector<uint64_t> bits;
+};
 
 class json_flag
 {
@@ -28,6 +62,9 @@ class json_flag
             return inherit_;
         }
 
+        /** Same as @ref inherit, but for an interned flag (see @ref flag_set::id) */
+        static bool inherit( int flag );
+
         /** Is this a valid (non-null) flag */
         operator bool() const {
             return !id_.empty();
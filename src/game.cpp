@@ -88,6 +88,8 @@
 #include "scent_map.h"
 #include "safemode_ui.h"
 #include "game_constants.h"
+#include "turn_profiler.h"
+#include "background_writer.h"
 
 #include <map>
 #include <set>
@@ -759,6 +761,7 @@ void game::setup()
 
     remoteveh_cache_turn = INT_MIN;
     remoteveh_cache = nullptr;
+    prefetch_center = tripoint_min;
     // back to menu for save loading, new game etc
 }
 
@@ -1398,6 +1401,7 @@ bool game::do_turn()
     if (is_game_over()) {
         return cleanup_at_end();
     }
+    turn_profiler::turn_scope profiled_turn;
     // Actual stuff
     if( new_game ) {
         new_game = false;
@@ -1410,10 +1414,17 @@ bool game::do_turn()
         load_npcs();
     }
 
-    process_events();
-    mission::process_all();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::process_events );
+        process_events();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::missions );
+        mission::process_all();
+    }
     if (calendar::turn.hours() == 0 && calendar::turn.minutes() == 0 &&
         calendar::turn.seconds() == 0) { // Midnight!
+        turn_profiler::scoped_timer timer( turn_profiler::stage::mongroups );
         overmap_buffer.process_mongroups();
         lua_callback("on_day_passed");
     }
@@ -1425,6 +1436,7 @@ bool game::do_turn()
 
     // Move hordes every 5 min
     if( calendar::once_every(MINUTES(5)) ) {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::move_hordes );
         overmap_buffer.move_hordes();
         // Hordes that reached the reality bubble need to spawn,
         // make them spawn in invisible areas only.
@@ -1433,15 +1445,21 @@ bool game::do_turn()
 
     u.update_body();
 
+    // Failures of the previous autosave could not be shown from the writer thread.
+    background_writer::report_failures();
     // Auto-save if autosave is enabled
     if (get_option<bool>( "AUTOSAVE" ) &&
         calendar::once_every(get_option<int>( "AUTOSAVE_TURNS" ) ) &&
         !u.is_dead_state()) {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::autosave );
         autosave();
     }
 
-    update_weather();
-    reset_light_level();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::weather );
+        update_weather();
+        reset_light_level();
+    }
 
     // The following happens when we stay still; 10/40 minutes overdue for spawn
     if ((!u.has_trait("INCONSPICUOUS") && calendar::turn > nextspawn + 100) ||
@@ -1450,13 +1468,17 @@ bool game::do_turn()
         nextspawn = calendar::turn;
     }
 
-    process_activity();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::activity );
+        process_activity();
+    }
 
     // Process sound events into sound markers for display to the player.
     sounds::process_sound_markers( &u );
 
     if (!u.in_sleep_state()) {
         if (u.moves > 0 || uquit == QUIT_WATCH) {
+            // Not profiled as a whole, handling an action mostly waits for the player.
             while (u.moves > 0 || uquit == QUIT_WATCH) {
                 cleanup_dead();
                 // Process any new sounds the player caused during their turn.
@@ -1478,6 +1500,7 @@ bool game::do_turn()
                     break;
                 }
                 if( u.activity ) {
+                    turn_profiler::scoped_timer timer( turn_profiler::stage::activity );
                     process_activity();
                 }
             }
@@ -1503,50 +1526,91 @@ bool game::do_turn()
     }
 
     // No-scent debug mutation has to be processed here or else it takes time to start working
-    if( !u.has_active_bionic( "bio_scent_mask" ) &&
-        !u.has_trait( "DEBUG_NOSCENT" ) ) {
-        scent.set( u.pos(), u.scent );
-        overmap_buffer.set_scent( u.global_omt_location(),  u.scent );
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::scent );
+        if( !u.has_active_bionic( "bio_scent_mask" ) &&
+            !u.has_trait( "DEBUG_NOSCENT" ) ) {
+            scent.set( u.pos(), u.scent );
+            overmap_buffer.set_scent( u.global_omt_location(),  u.scent );
+        }
+        scent.update( u.pos(), m );
     }
-    scent.update( u.pos(), m );
 
     // We need floor cache before checking falling 'n stuff
-    m.build_floor_caches();
-
-    m.process_falling();
-    m.vehmove();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::floor_caches );
+        m.build_floor_caches();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::falling );
+        m.process_falling();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::vehmove );
+        m.vehmove();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::map_prefetch );
+        prefetch_ahead();
+        MAPBUFFER.integrate_prefetched( 1 );
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::map_evict );
+        MAPBUFFER.evict_unused( mapbuffer::submap_budget() );
+    }
 
     // Process power and fuel consumption for all vehicles, including off-map ones.
     // m.vehmove used to do this, but now it only give them moves instead.
-    for( auto &elem : MAPBUFFER ) {
-        tripoint sm_loc = elem.first;
-        point sm_topleft = sm_to_ms_copy(sm_loc.x, sm_loc.y);
-        point in_reality = m.getlocal(sm_topleft);
-
-        submap *sm = elem.second;
-
-        const bool in_bubble_z = m.has_zlevels() || sm_loc.z == get_levz();
-        for( auto &veh : sm->vehicles ) {
-            veh->power_parts();
-            veh->idle( in_bubble_z && m.inbounds(in_reality.x, in_reality.y) );
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::vehicle_idle );
+        const tripoint abs_sub = m.get_abs_sub();
+        for( const wrapped_vehicle &w : m.get_vehicles() ) {
+            // Once off the map, only those vehicles are processed.
+            if( w.v->needs_upkeep() ) {
+                MAPBUFFER.register_vehicle_upkeep( tripoint( abs_sub.x + w.i, abs_sub.y + w.j, w.z ) );
+            }
+            w.v->power_parts();
+            w.v->idle( true );
         }
+        MAPBUFFER.process_vehicles_outside_bubble();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::fields );
+        m.process_fields();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::active_items );
+        m.process_active_items();
     }
-    m.process_fields();
-    m.process_active_items();
     m.creature_in_field( u );
 
     // Apply sounds from previous turn to monster and NPC AI.
-    sounds::process_sounds();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::sounds );
+        sounds::process_sounds();
+    }
     // Update vision caches for monsters. If this turns out to be expensive,
     // consider a stripped down cache just for monsters.
-    m.build_map_cache( get_levz(), true );
-    monmove();
-    update_stair_monsters();
-    u.process_turn();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::map_cache );
+        m.build_map_cache( get_levz(), true );
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::monmove );
+        monmove();
+        update_stair_monsters();
+    }
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::player_turn );
+        u.process_turn();
+    }
     if( u.moves < 0 && get_option<bool>( "FORCE_REDRAW" ) ) {
         draw();
     }
-    u.process_active_items();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::active_items );
+        u.process_active_items();
+    }
 
     if (get_levz() >= 0 && !u.is_underwater()) {
         weather_data(weather).effect();
@@ -1557,17 +1621,20 @@ bool game::do_turn()
         refresh();
     }
 
-    u.update_bodytemp();
-    u.update_body_wetness( *weather_precise );
-    u.apply_wetness_morale( temperature );
-    rustCheck();
+    {
+        turn_profiler::scoped_timer timer( turn_profiler::stage::player_upkeep );
+        u.update_bodytemp();
+        u.update_body_wetness( *weather_precise );
+        u.apply_wetness_morale( temperature );
+        rustCheck();
 
-    if( calendar::once_every( MINUTES( 1 ) ) ) {
-        u.update_morale();
-    }
+        if( calendar::once_every( MINUTES( 1 ) ) ) {
+            u.update_morale();
+        }
 
-    if( calendar::once_every( SECONDS( 90 ) ) ) {
-        u.check_and_recover_morale();
+        if( calendar::once_every( SECONDS( 90 ) ) ) {
+            u.check_and_recover_morale();
+        }
     }
 
     sfx::remove_hearing_loss();
@@ -3728,7 +3795,7 @@ bool game::save_factions_missions_npcs()
     }
 
     std::string masterfile = world_generator->active_world->world_path + "/master.gsav";
-    return write_to_file_exclusive( masterfile, [&]( std::ostream &fout ) {
+    return write_to_file_deferred( masterfile, [&]( std::ostream &fout ) {
         serialize_master(fout);
     }, _( "factions data" ) );
 }
@@ -3755,7 +3822,7 @@ bool game::save_maps()
 bool game::save_uistate()
 {
     std::string savefile = world_generator->active_world->world_path + "/uistate.json";
-    return write_to_file_exclusive( savefile, [&]( std::ostream &fout ) {
+    return write_to_file_deferred( savefile, [&]( std::ostream &fout ) {
         fout << uistate.serialize();
     }, _( "uistate data" ) );
 }
@@ -3764,13 +3831,13 @@ bool game::save_player_data()
 {
     const std::string playerfile = world_generator->active_world->world_path + "/" + base64_encode(u.name);
 
-    const bool saved_data = write_to_file( playerfile + ".sav", [&]( std::ostream &fout ) {
+    const bool saved_data = write_to_file_deferred( playerfile + ".sav", [&]( std::ostream &fout ) {
         serialize(fout);
     }, _( "player data" ) );
-    const bool saved_weather = write_to_file( playerfile + ".weather", [&]( std::ostream &fout ) {
+    const bool saved_weather = write_to_file_deferred( playerfile + ".weather", [&]( std::ostream &fout ) {
         save_weather(fout);
     }, _( "weather state" ) );
-    const bool saved_log = write_to_file( playerfile + ".log", [&]( std::ostream &fout ) {
+    const bool saved_log = write_to_file_deferred( playerfile + ".log", [&]( std::ostream &fout ) {
         fout << u.dump_memorial();
     }, _( "player memorial" ) );
 
@@ -3812,6 +3879,8 @@ static bool isForbidden(std::string candidate)
 // If it's false, just avoid deleting the two config files and the directory itself.
 void game::delete_world(std::string worldname, bool delete_folder)
 {
+    // Pending writes would otherwise recreate some of the deleted files.
+    background_writer::flush();
     std::string worldpath = world_generator->all_worlds[worldname]->world_path;
     std::set<std::string> directory_paths;
 
@@ -3988,6 +4057,7 @@ void game::debug()
                        _( "Set automove route" ),     // 28
                        _( "Show mutation category levels" ), // 29
                        _( "Overmap editor" ),         // 30
+                       _( "Turn profiler" ),          // 31
                        _( "Cancel" ),
                        NULL );
     int veh_num;
@@ -4682,11 +4752,69 @@ void game::debug()
             overmap::draw_editor();
         }
         break;
+        case 31: {
+            uimenu pmenu;
+            pmenu.return_invalid = true;
+            pmenu.text = string_format( _( "Turns recorded: %d" ), turn_profiler::recorded_turns() );
+            pmenu.addentry( 0, true, 'e', turn_profiler::is_enabled() ? _( "Disable profiling" ) :
+                            _( "Enable profiling" ) );
+            pmenu.addentry( 1, true, 's', _( "Show stage statistics" ) );
+            pmenu.addentry( 2, true, 'x', _( "Export Chrome trace" ) );
+            pmenu.addentry( 3, true, 'c', _( "Clear recorded data" ) );
+            pmenu.query();
+            switch( pmenu.ret ) {
+                case 0:
+                    turn_profiler::set_enabled( !turn_profiler::is_enabled() );
+                    break;
+                case 1:
+                    display_turn_profile();
+                    break;
+                case 2: {
+                    const std::string path = FILENAMES["config_dir"] + "turn_trace.json";
+                    if( turn_profiler::write_chrome_trace( path ) ) {
+                        popup( _( "Trace written to %s" ), path.c_str() );
+                    }
+                }
+                break;
+                case 3:
+                    turn_profiler::clear();
+                    break;
+                default:
+                    break;
+            }
+        }
+        break;
     }
     erase();
     refresh_all();
 }
 
+void game::display_turn_profile()
+{
+    WINDOW *w = newwin( FULL_SCREEN_HEIGHT, FULL_SCREEN_WIDTH,
+                        std::max( 0, ( TERMY - FULL_SCREEN_HEIGHT ) / 2 ),
+                        std::max( 0, ( TERMX - FULL_SCREEN_WIDTH ) / 2 ) );
+
+    std::vector<std::string> data;
+    data.push_back( string_format( "%-24s %8s %8s %8s %8s", _( "Stage" ), "p50", "p99", "max",
+                                   _( "calls" ) ) );
+    for( int i = 0; i < static_cast<int>( turn_profiler::stage::num_stages ); ++i ) {
+        const auto st = static_cast<turn_profiler::stage>( i );
+        const auto summary = turn_profiler::summarize( st );
+        data.push_back( string_format( "%-24s %8.2f %8.2f %8.2f %8.1f",
+                                       turn_profiler::stage_name( st ), summary.p50_ms,
+                                       summary.p99_ms, summary.max_ms, summary.calls_per_turn ) );
+    }
+    const std::string title = string_format( _( "Time per turn in ms, last %d turns" ),
+                              turn_profiler::recorded_turns() );
+    display_table( w, title, 1, data );
+
+    werase( w );
+    wrefresh( w );
+    delwin( w );
+    refresh_all();
+}
+
 void game::draw_overmap()
 {
     overmap::draw_overmap();
@@ -13426,6 +13554,8 @@ void game::update_map(int &x, int &y)
 
     // this handles loading/unloading submaps that have scrolled on or off the viewport
     m.shift( shiftx, shifty );
+    // Whatever moved us is likely to continue in the same direction.
+    prefetch_submaps( m.get_abs_sub() + tripoint( MAPSIZE / 2 + shiftx, MAPSIZE / 2 + shifty, 0 ) );
 
     // Shift monsters
     shift_monsters( shiftx, shifty, 0 );
@@ -13468,6 +13598,43 @@ void game::update_map(int &x, int &y)
     update_overmap_seen();
 }
 
+void game::prefetch_submaps( const tripoint &center )
+{
+    const int zmin = m.has_zlevels() ? -OVERMAP_DEPTH : center.z;
+    const int zmax = m.has_zlevels() ? OVERMAP_HEIGHT : center.z;
+    // Quads are read as a whole, one submap per quad is enough.
+    const int xmin = center.x - MAPSIZE / 2;
+    const int ymin = center.y - MAPSIZE / 2;
+    for( int z = zmin; z <= zmax; z++ ) {
+        for( int x = xmin - ( abs( xmin ) % 2 ); x <= center.x + MAPSIZE / 2; x += 2 ) {
+            for( int y = ymin - ( abs( ymin ) % 2 ); y <= center.y + MAPSIZE / 2; y += 2 ) {
+                MAPBUFFER.prefetch( tripoint( x, y, z ) );
+            }
+        }
+    }
+}
+
+void game::prefetch_ahead()
+{
+    // How many turns in advance the submaps should be read.
+    static const int lookahead_turns = 5;
+
+    const vehicle *veh = u.controlling_vehicle ? m.veh_at( u.pos() ) : nullptr;
+    if( veh == nullptr || veh->velocity == 0 ) {
+        return;
+    }
+    // A vehicle moves velocity / 1000 tiles per turn, see map::vehproceed.
+    const double distance = lookahead_turns * veh->velocity / 1000.0;
+    const double angle = veh->face.dir() * M_PI / 180;
+    const point ahead( u.posx() + int( distance * cos( angle ) ),
+                       u.posy() + int( distance * sin( angle ) ) );
+    const tripoint center = m.get_abs_sub() + ms_to_sm_copy( ahead );
+    if( center != prefetch_center ) {
+        prefetch_center = center;
+        prefetch_submaps( center );
+    }
+}
+
 void game::update_overmap_seen()
 {
     const tripoint ompos = u.global_omt_location();
@@ -14237,6 +14404,8 @@ void game::autosave()
     if (time(NULL) < last_save_timestamp + 60 * get_option<int>( "AUTOSAVE_MINUTES" ) ) {
         return;
     }
+    // Serialize now, but let the writer thread do the slow file I/O while the game continues.
+    background_writer::deferred_scope deferred;
     quicksave();    //Driving checks are handled by quicksave()
 }
 
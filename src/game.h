@@ -420,6 +420,13 @@ class game
         void update_map( player &p );
         void update_map(int &x, int &y);
         void update_overmap_seen(); // Update which overmap tiles we can see
+        /**
+         * Read the submaps of the reality bubble around the given absolute submap
+         * position in the background, see @ref mapbuffer::prefetch.
+         */
+        void prefetch_submaps( const tripoint &center );
+        /** Prefetch the submaps the player is heading to, based on the speed of their vehicle. */
+        void prefetch_ahead();
 
         void process_artifact(item *it, player *p);
         void add_artifact_messages(std::vector<art_effect_passive> effects);
@@ -921,6 +928,7 @@ private:
         // Debug functions
         void debug();           // All-encompassing debug screen.  TODO: This.
         void display_scent();   // Displays the scent map
+        void display_turn_profile(); // Displays per-stage timings of do_turn
         void groupdebug();      // Get into on monster groups
 
         // ########################## DATA ################################
@@ -947,6 +955,8 @@ private:
         // remoteveh() cache
         int remoteveh_cache_turn;
         vehicle *remoteveh_cache;
+        /** Submap around which @ref prefetch_ahead requested the bubble last. */
+        tripoint prefetch_center;
         /** Has a NPC been spawned since last load? */
         bool npcs_dirty;
 
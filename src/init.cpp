@@ -63,6 +63,15 @@
 #include <fstream>
 #include <sstream> // for throwing errors
 #include <locale> // for loading names
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
 
 DynamicDataLoader::DynamicDataLoader()
 {
@@ -84,7 +93,9 @@ void DynamicDataLoader::load_object( JsonObject &jo, const std::string &src )
     if (it == type_function_map.end()) {
         jo.throw_error( "unrecognized JSON object", "type" );
     }
+    const auto start = std::chrono::steady_clock::now();
     it->second( jo, src );
+    times.types[type] += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
 }
 
 bool DynamicDataLoader::load_deferred( deferred_json& data )
@@ -94,8 +105,7 @@ bool DynamicDataLoader::load_deferred( deferred_json& data )
         auto it = data.begin();
         for( size_t idx = 0; idx != n; ++idx ) {
             try {
-                std::istringstream str( it->first );
-                JsonIn jsin( str );
+                JsonIn jsin( it->first.data(), it->first.size() );
                 JsonObject jo = jsin.get_object();
                 load_object( jo, it->second );
             } catch( const std::exception &err ) {
@@ -239,6 +249,142 @@ void DynamicDataLoader::initialize()
     add( "mission_definition", []( JsonObject &jo, const std::string &src ) { mission_type::load_mission_type( jo, src ); } );
 }
 
+namespace
+{
+
+/** A data file that has been read and whose top level objects have been indexed. */
+struct json_file {
+    std::string name;
+    std::string contents;
+    std::unique_ptr<JsonIn> jsin;
+    /** Declared after jsin, they move it to their end when destroyed. */
+    std::deque<JsonObject> objects;
+    /** Set if the file is broken, the objects before the error are loaded anyway. */
+    std::string error;
+    double io_time = 0;
+    double parsing_time = 0;
+    bool ready = false;
+};
+
+/** Same as DynamicDataLoader::load_all_from_json, but only indexes the objects. */
+void index_objects( json_file &file )
+{
+    JsonIn &jsin = *file.jsin;
+    if( jsin.test_object() ) {
+        file.objects.emplace_back( jsin );
+        file.objects.back().finish();
+        // if there's anything else in the file, it's an error.
+        jsin.eat_whitespace();
+        if( jsin.good() ) {
+            jsin.error( string_format( "expected single-object file but found '%c'", jsin.peek() ) );
+        }
+    } else if( jsin.test_array() ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            file.objects.emplace_back( jsin );
+            file.objects.back().finish();
+        }
+    } else {
+        // not an object or an array?
+        jsin.error( "expected object or array" );
+    }
+}
+
+void read_file( json_file &file )
+{
+    const auto start = std::chrono::steady_clock::now();
+    {
+        // open the file as a stream and stuff it into ram
+        std::ifstream infile( file.name.c_str(), std::ifstream::in | std::ifstream::binary );
+        file.contents.assign( std::istreambuf_iterator<char>( infile ),
+                              std::istreambuf_iterator<char>() );
+    }
+    const auto read = std::chrono::steady_clock::now();
+    try {
+        file.jsin.reset( new JsonIn( file.contents.data(), file.contents.size() ) );
+        index_objects( file );
+    } catch( const std::exception &err ) {
+        file.error = err.what();
+    }
+    file.io_time = std::chrono::duration<double>( read - start ).count();
+    file.parsing_time = std::chrono::duration<double>( std::chrono::steady_clock::now() - read ).count();
+}
+
+/**
+ * Reads and indexes the files on worker threads, in the order of the files. Nothing in
+ * there touches global state, the objects themselves are loaded on the main thread.
+ */
+class json_file_reader
+{
+    public:
+        json_file_reader( const std::vector<std::string> &names ) : files( names.size() ) {
+            for( size_t i = 0; i < names.size(); i++ ) {
+                files[i].name = names[i];
+            }
+            const size_t num_threads = std::min<size_t>( names.size(),
+                                       std::max( 1u, std::thread::hardware_concurrency() ) );
+            for( size_t i = 0; i < num_threads; i++ ) {
+                workers.emplace_back( &json_file_reader::run, this );
+            }
+        }
+        ~json_file_reader() {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                stopping = true;
+            }
+            for( auto &worker : workers ) {
+                worker.join();
+            }
+        }
+
+        size_t size() const {
+            return files.size();
+        }
+
+        /** Waits until the file has been read, returns how long that took. */
+        double wait_for( size_t index ) {
+            const auto start = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock( mutex );
+            ready.wait( lock, [this, index]() {
+                return files[index].ready;
+            } );
+            return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        json_file &operator[]( size_t index ) {
+            return files[index];
+        }
+
+    private:
+        void run() {
+            while( true ) {
+                size_t index;
+                {
+                    std::lock_guard<std::mutex> lock( mutex );
+                    if( stopping || next == files.size() ) {
+                        return;
+                    }
+                    index = next++;
+                }
+                read_file( files[index] );
+                {
+                    std::lock_guard<std::mutex> lock( mutex );
+                    files[index].ready = true;
+                }
+                ready.notify_all();
+            }
+        }
+
+        std::vector<json_file> files;
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable ready;
+        size_t next = 0;
+        bool stopping = false;
+};
+
+}
+
 void DynamicDataLoader::load_data_from_path( const std::string &path, const std::string &src )
 {
     // We assume that each folder is consistent in itself,
@@ -257,25 +403,28 @@ void DynamicDataLoader::load_data_from_path( const std::string &path, const std:
             files.push_back(path);
         }
     }
-    // iterate over each file
-    for( auto &files_i : files ) {
-        const std::string &file = files_i;
-        // open the file as a stream
-        std::ifstream infile(file.c_str(), std::ifstream::in | std::ifstream::binary);
-        // and stuff it into ram
-        std::istringstream iss(
-            std::string(
-                (std::istreambuf_iterator<char>(infile)),
-                std::istreambuf_iterator<char>()
-            )
-        );
+    json_file_reader reader( files );
+    // iterate over each file, in order
+    for( size_t i = 0; i < reader.size(); i++ ) {
+        times.waiting += reader.wait_for( i );
+        json_file &file = reader[i];
+        times.io += file.io_time;
+        times.parsing += file.parsing_time;
         try {
-            // parse it
-            JsonIn jsin(iss);
-            load_all_from_json( jsin, src );
+            for( JsonObject &jo : file.objects ) {
+                load_object( jo, src );
+                jo.finish();
+            }
         } catch( const JsonError &err ) {
-            throw std::runtime_error( file + ": " + err.what() );
+            throw std::runtime_error( file.name + ": " + err.what() );
+        }
+        if( !file.error.empty() ) {
+            throw std::runtime_error( file.name + ": " + file.error );
         }
+        // The contents are not needed anymore.
+        file.objects.clear();
+        file.jsin.reset();
+        file.contents = std::string();
     }
 }
 
@@ -367,6 +516,8 @@ void DynamicDataLoader::unload_data()
 extern void calculate_mapgen_weights();
 void DynamicDataLoader::finalize_loaded_data()
 {
+    const auto start = std::chrono::steady_clock::now();
+    emit::finalize();
     item_controller->finalize();
     vpart_info::finalize();
     set_ter_ids();
@@ -384,7 +535,11 @@ void DynamicDataLoader::finalize_loaded_data()
     finialize_martial_arts();
     finalize_constructions();
     npc_class::finalize_all();
+    const auto finalized = std::chrono::steady_clock::now();
+    times.finalizing += std::chrono::duration<double>( finalized - start ).count();
     check_consistency();
+    times.checking += std::chrono::duration<double>( std::chrono::steady_clock::now() -
+                      finalized ).count();
 }
 
 void DynamicDataLoader::check_consistency()
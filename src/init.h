@@ -8,6 +8,7 @@
 #include <list>
 #include <memory>
 #include <functional>
+#include <map>
 
 /**
  * This class is used to load (and unload) the dynamic
@@ -59,6 +60,22 @@ class DynamicDataLoader
          */
         typedef std::list<std::pair<std::string, std::string>> deferred_json;
 
+        /** Seconds spent loading data, summed over all calls of @ref load_data_from_path. */
+        struct loading_times {
+            /** Reading the files, summed over all loader threads. */
+            double io = 0;
+            /** Indexing the objects in the files, summed over all loader threads. */
+            double parsing = 0;
+            /** The main thread waiting for files that have not been indexed yet. */
+            double waiting = 0;
+            /** Loading the objects (including deferred ones), by type. */
+            std::map<type_string, double> types;
+            /** The finalize functions in @ref finalize_loaded_data. */
+            double finalizing = 0;
+            /** The checks in @ref check_consistency. */
+            double checking = 0;
+        };
+
     protected:
         /**
          * Maps the type string (comming from json) to the
@@ -82,6 +99,8 @@ class DynamicDataLoader
          */
         void load_object( JsonObject &jo, const std::string &src );
 
+        loading_times times;
+
         DynamicDataLoader();
         ~DynamicDataLoader();
         /**
@@ -102,6 +121,8 @@ class DynamicDataLoader
         /**
          * Load all data from json files located in
          * the path (recursive).
+         * The files are read and their objects are indexed on several threads, the objects
+         * are loaded on the calling thread in the order of the files.
          * @param path Either a folder (recursively load all
          * files with the extension .json), or a file (load only
          * that file, don't check extension).
@@ -127,6 +148,10 @@ class DynamicDataLoader
          * @return whether all entries were sucessfully loaded
          */
         bool load_deferred( deferred_json &data );
+
+        const loading_times &get_loading_times() const {
+            return times;
+        }
 };
 
 void init_names();
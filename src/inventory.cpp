@@ -88,6 +88,15 @@ inventory &inventory::operator+= (const inventory &rhs)
     for (size_t i = 0; i < rhs.size(); i++) {
         add_stack(rhs.const_stack(i));
     }
+    if( rhs.uncopied ) {
+        std::shared_ptr<inventory_index> counted = std::make_shared<inventory_index>();
+        if( uncopied ) {
+            counted->add( *uncopied );
+        }
+        counted->add( *rhs.uncopied );
+        uncopied = counted;
+        index.reset();
+    }
     return *this;
 }
 
@@ -147,6 +156,8 @@ void inventory::sort()
 void inventory::clear()
 {
     items.clear();
+    index.reset();
+    uncopied.reset();
 }
 
 void inventory::add_stack(const std::list<item> newits)
@@ -166,6 +177,7 @@ void inventory::clone_stack (const std::list<item> &rhs)
         newstack.push_back( rh );
     }
     items.push_back(newstack);
+    index.reset();
 }
 
 void inventory::push_back(std::list<item> newits)
@@ -243,6 +255,7 @@ char inventory::find_usable_cached_invlet(const std::string &item_type)
 item &inventory::add_item(item newit, bool keep_invlet, bool assign_invlet)
 {
     bool reuse_cached_letter = false;
+    index.reset();
 
     // Avoid letters that have been manually assigned to other things.
     if( !keep_invlet && g->u.assigned_invlet.count(newit.invlet) ) {
@@ -380,8 +393,31 @@ static long count_charges_in_list(const itype *type, const map_stack &items)
 }
 
 void inventory::form_from_map( const tripoint &origin, int range, bool assign_invlet )
+{
+    form_from_map( origin, range, assign_invlet, nullptr );
+}
+
+void inventory::form_index_from_map( const tripoint &origin, int range )
+{
+    std::shared_ptr<inventory_index> counted = std::make_shared<inventory_index>();
+    form_from_map( origin, range, false, counted.get() );
+    uncopied = counted;
+}
+
+void inventory::form_from_map( const tripoint &origin, int range, bool assign_invlet,
+                               inventory_index *counted )
 {
     items.clear();
+    index.reset();
+    uncopied.reset();
+    // Items that exist on the map, as opposed to the pseudo items created here.
+    const auto add_map_item = [this, counted, assign_invlet]( const item &it ) {
+        if( counted != nullptr ) {
+            counted->add( it, 1 );
+        } else {
+            add_item( it, false, assign_invlet );
+        }
+    };
     for( const tripoint &p : g->m.points_in_radius( origin, range ) ) {
         if (g->m.has_furn( p ) && g->m.accessible_furniture( origin, p, range )) {
             const furn_t &f = g->m.furn( p ).obj();
@@ -398,7 +434,7 @@ void inventory::form_from_map( const tripoint &origin, int range, bool assign_in
         }
         for (auto &i : g->m.i_at( p )) {
             if (!i.made_of(LIQUID)) {
-                add_item(i, false, assign_invlet);
+                add_map_item( i );
             }
         }
         // Kludges for now!
@@ -425,7 +461,7 @@ void inventory::form_from_map( const tripoint &origin, int range, bool assign_in
                 }
             }
             if( water != toilet.end() && water->charges > 0) {
-                add_item( *water );
+                add_map_item( *water );
             }
         }
 
@@ -434,7 +470,7 @@ void inventory::form_from_map( const tripoint &origin, int range, bool assign_in
             auto liq_contained = g->m.i_at( p );
             for( auto &i : liq_contained ) {
                 if( i.made_of(LIQUID) ) {
-                    add_item(i);
+                    add_map_item( i );
                 }
             }
         }
@@ -461,8 +497,9 @@ void inventory::form_from_map( const tripoint &origin, int range, bool assign_in
         const int cargo = veh->part_with_feature(vpart, "CARGO");
 
         if (cargo >= 0) {
-            *this += std::list<item>( veh->get_items(cargo).begin(),
-                                      veh->get_items(cargo).end() );
+            for( const item &it : veh->get_items( cargo ) ) {
+                add_map_item( it );
+            }
         }
 
         if(faupart >= 0 ) {
@@ -550,6 +587,7 @@ std::list<item> inventory::reduce_stack_internal(const Locator &locator, int qua
 {
     int pos = 0;
     std::list<item> ret;
+    index.reset();
     for (invstack::iterator iter = items.begin(); iter != items.end(); ++iter) {
         if (item_matches_locator(iter->front(), locator, pos)) {
             if(quantity >= (int)iter->size() || quantity < 0) {
@@ -592,6 +630,7 @@ template<typename Locator>
 item inventory::remove_item_internal(const Locator &locator)
 {
     int pos = 0;
+    index.reset();
     for (invstack::iterator iter = items.begin(); iter != items.end(); ++iter) {
         if (item_matches_locator(iter->front(), locator, pos)) {
             if (iter->size() > 1) {
@@ -623,6 +662,7 @@ std::list<item> inventory::remove_randomly_by_volume( const units::volume &volum
 {
     std::list<item> result;
     units::volume volume_dropped = 0;
+    index.reset();
     while( volume_dropped < volume ) {
         units::volume cumulative_volume = 0;
         auto chosen_stack = items.begin();
@@ -652,6 +692,7 @@ std::list<item> inventory::remove_randomly_by_volume( const units::volume &volum
 
 void inventory::dump(std::vector<item *> &dest)
 {
+    index.reset();
     for( auto &elem : items ) {
         for( auto &elem_stack_iter : elem ) {
             dest.push_back( &( elem_stack_iter ) );
@@ -760,6 +801,7 @@ std::list<item> inventory::use_amount(itype_id it, int _quantity)
     long quantity = _quantity; // Don't wanny change the function signature right now
     sort();
     std::list<item> ret;
+    index.reset();
     for (invstack::iterator iter = items.begin(); iter != items.end() && quantity > 0; /* noop */) {
         for (std::list<item>::iterator stack_iter = iter->begin();
              stack_iter != iter->end() && quantity > 0;
@@ -781,16 +823,25 @@ std::list<item> inventory::use_amount(itype_id it, int _quantity)
 
 bool inventory::has_tools(itype_id it, int quantity) const
 {
+    if( const auto index = get_index() ) {
+        return index->amount_of( it, true ) >= quantity;
+    }
     return has_amount(it, quantity, true);
 }
 
 bool inventory::has_components(itype_id it, int quantity) const
 {
+    if( const auto index = get_index() ) {
+        return index->amount_of( it, false ) >= quantity;
+    }
     return has_amount(it, quantity, false);
 }
 
 bool inventory::has_charges(itype_id it, long quantity) const
 {
+    if( const auto index = get_index() ) {
+        return index->charges_of( it ) >= quantity;
+    }
     return (charges_of(it) >= quantity);
 }
 
@@ -908,6 +959,7 @@ item *inventory::most_loaded_gun()
 
 void inventory::rust_iron_items()
 {
+    index.reset();
     for( auto &elem : items ) {
         for( auto &elem_stack_iter : elem ) {
             if( elem_stack_iter.made_of( material_id( "iron" ) ) &&
@@ -1012,3 +1064,181 @@ std::set<char> inventory::allocated_invlets() const
     }
     return invlets;
 }
+
+void inventory::build_index() const
+{
+    std::shared_ptr<inventory_index> result = std::make_shared<inventory_index>();
+    if( uncopied ) {
+        result->add( *uncopied );
+    }
+    for( const auto &stack : items ) {
+        result->add( stack.front(), stack.size() );
+    }
+    index = result;
+}
+
+std::shared_ptr<const inventory_index> inventory::get_index() const
+{
+    if( !index && uncopied ) {
+        build_index();
+    }
+    return index;
+}
+
+// Same as visit_internal in visitable.cpp
+static bool visits_contents( const item &it )
+{
+    return !it.is_gun() && !it.is_magazine() && !it.is_non_resealable_container();
+}
+
+// Same as item::get_quality for all qualities at once.
+static std::map<quality_id, int> quality_levels( const item &it )
+{
+    std::map<quality_id, int> result = it.type->qualities;
+    for( const item &e : it.contents ) {
+        for( const auto &q : quality_levels( e ) ) {
+            auto iter = result.emplace( q.first, q.second ).first;
+            iter->second = std::max( iter->second, q.second );
+        }
+    }
+    return result;
+}
+
+static void add_qualities( inventory_index &index, const item &it, long count )
+{
+    for( const auto &q : quality_levels( it ) ) {
+        index.qualities[q.first][q.second] += count * ( it.count_by_charges() ? it.charges : 1 );
+    }
+    if( visits_contents( it ) ) {
+        for( const item &e : it.contents ) {
+            add_qualities( index, e, count );
+        }
+    }
+}
+
+static void add_amounts( inventory_index &index, const item &it, long count )
+{
+    if( it.allow_crafting_component() ) {
+        index.amount[it.typeId()] += count;
+        if( !it.has_flag( "PSEUDO" ) ) {
+            index.amount_without_pseudo[it.typeId()] += count;
+        }
+    }
+    if( visits_contents( it ) ) {
+        for( const item &e : it.contents ) {
+            add_amounts( index, e, count );
+        }
+    }
+}
+
+// Mirrors charges_of_internal in visitable.cpp
+static void add_charges( inventory_index &index, const item &it, long count )
+{
+    if( it.is_tool() ) {
+        const long charges = count * it.ammo_remaining();
+        index.charges[it.typeId()] += charges;
+        if( it.type->tool->subtype != it.typeId() ) {
+            index.charges[it.type->tool->subtype] += charges;
+        }
+    } else if( it.count_by_charges() ) {
+        index.charges[it.typeId()] += count * it.charges;
+    } else if( visits_contents( it ) ) {
+        for( const item &e : it.contents ) {
+            add_charges( index, e, count );
+        }
+    }
+}
+
+void inventory_index::add( const item &it, long count )
+{
+    add_qualities( *this, it, count );
+    add_amounts( *this, it, count );
+    add_charges( *this, it, count );
+    if( it.is_book() ) {
+        books.insert( it.typeId() );
+    }
+}
+
+void inventory_index::add( const inventory_index &other )
+{
+    for( const auto &e : other.amount ) {
+        amount[e.first] += e.second;
+    }
+    for( const auto &e : other.amount_without_pseudo ) {
+        amount_without_pseudo[e.first] += e.second;
+    }
+    for( const auto &e : other.charges ) {
+        charges[e.first] += e.second;
+    }
+    for( const auto &q : other.qualities ) {
+        for( const auto &lvl : q.second ) {
+            qualities[q.first][lvl.first] += lvl.second;
+        }
+    }
+    books.insert( other.books.begin(), other.books.end() );
+}
+
+int inventory_index::amount_of( const itype_id &type, bool pseudo ) const
+{
+    const auto &amounts = pseudo ? amount : amount_without_pseudo;
+    const auto iter = amounts.find( type );
+    return iter != amounts.end() ? iter->second : 0;
+}
+
+long inventory_index::charges_of( const itype_id &type ) const
+{
+    const auto iter = charges.find( type );
+    return iter != charges.end() ? iter->second : 0;
+}
+
+bool inventory_index::has_quality( const quality_id &qual, int level, int qty ) const
+{
+    const auto iter = qualities.find( qual );
+    if( iter == qualities.end() ) {
+        return false;
+    }
+    long found = 0;
+    for( auto lvl = iter->second.lower_bound( level ); lvl != iter->second.end(); ++lvl ) {
+        found += lvl->second;
+        if( found >= qty ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename K, typename V>
+static void add_changes( const std::unordered_map<K, V> &lhs, const std::unordered_map<K, V> &rhs,
+                         std::set<K> &result )
+{
+    for( const auto &e : lhs ) {
+        const auto iter = rhs.find( e.first );
+        if( iter == rhs.end() || iter->second != e.second ) {
+            result.insert( e.first );
+        }
+    }
+    for( const auto &e : rhs ) {
+        if( lhs.count( e.first ) == 0 ) {
+            result.insert( e.first );
+        }
+    }
+}
+
+void inventory_index::changes( const inventory_index &other, std::set<itype_id> &types,
+                               std::set<quality_id> &quals ) const
+{
+    add_changes( amount, other.amount, types );
+    add_changes( amount_without_pseudo, other.amount_without_pseudo, types );
+    add_changes( charges, other.charges, types );
+    for( const auto &e : qualities ) {
+        const auto iter = other.qualities.find( e.first );
+        if( iter == other.qualities.end() || iter->second != e.second ) {
+            quals.insert( e.first );
+        }
+    }
+    for( const auto &e : other.qualities ) {
+        if( qualities.count( e.first ) == 0 ) {
+            quals.insert( e.first );
+        }
+    }
+}
@@ -6,7 +6,11 @@
 #include "enums.h"
 
 #include <list>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <functional>
@@ -47,6 +51,32 @@ public:
 
 const extern invlet_wrapper inv_chars;
 
+/**
+ * Totals over all items of an inventory (including their contents), so the crafting
+ * requirements can be checked with a lookup instead of visiting every item.
+ * See @ref inventory::build_index and @ref inventory::form_index_from_map.
+ */
+struct inventory_index {
+    /** Same as @ref inventory::amount_of with and without pseudo items, by item type. */
+    std::unordered_map<itype_id, int> amount;
+    std::unordered_map<itype_id, int> amount_without_pseudo;
+    /** Same as @ref inventory::charges_of, tools are also counted for their subtype. */
+    std::unordered_map<itype_id, long> charges;
+    /** For each quality the number of items that have it at exactly that level. */
+    std::map<quality_id, std::map<int, long>> qualities;
+    /** Types of the books that are not inside other items. */
+    std::set<itype_id> books;
+
+    void add( const item &it, long count );
+    void add( const inventory_index &other );
+    int amount_of( const itype_id &type, bool pseudo ) const;
+    long charges_of( const itype_id &type ) const;
+    bool has_quality( const quality_id &qual, int level, int qty ) const;
+    /** Collects the item types and qualities whose totals differ from the ones in @p other. */
+    void changes( const inventory_index &other, std::set<itype_id> &types,
+                  std::set<quality_id> &quals ) const;
+};
+
 class inventory : public visitable<inventory>
 {
     public:
@@ -91,6 +121,16 @@ class inventory : public visitable<inventory>
         void restack(player *p = NULL);
 
         void form_from_map( const tripoint &origin, int distance, bool assign_invlet = true );
+        /**
+         * Same as @ref form_from_map, but the items on the map and in vehicle cargo are not
+         * copied, they are only counted in the index (see @ref build_index). Only the pseudo
+         * items of furniture, fires, water sources and vehicle parts are added as items.
+         * So only the lookups answered by the index see the nearby items: @ref has_tools,
+         * @ref has_components, @ref has_charges, @ref has_quality, @ref amount_of,
+         * @ref charges_of and the books in @ref get_index. That is all checking crafting
+         * requirements needs.
+         */
+        void form_index_from_map( const tripoint &origin, int distance );
 
         /**
          * Remove a specific item from the inventory. The item is compared
@@ -173,11 +213,28 @@ class inventory : public visitable<inventory>
 
         std::set<char> allocated_invlets() const;
 
+        /**
+         * Builds an @ref inventory_index that is used by @ref has_tools, @ref has_components,
+         * @ref has_charges, @ref has_quality, @ref amount_of and @ref charges_of from now on.
+         * Adding or removing items drops it again, changing items through references does
+         * not, so this is only meant for inventories that are not changed in place, like the
+         * crafting inventory.
+         */
+        void build_index() const;
+        /**
+         * The index built by @ref build_index, if any. Inventories formed by
+         * @ref form_index_from_map always have one, it's rebuilt when needed.
+         */
+        std::shared_ptr<const inventory_index> get_index() const;
+
     private:
         // For each item ID, store a set of "favorite" inventory letters.
         std::map<std::string, std::vector<char> > invlet_cache;
         void update_cache_with_item(item &newit);
         char find_usable_cached_invlet(const std::string &item_type);
+        /** Implements @ref form_from_map, the map items are only counted if counted isn't null. */
+        void form_from_map( const tripoint &origin, int range, bool assign_invlet,
+                            inventory_index *counted );
 
         // Often items can be located using typeid, position, or invlet.  To reduce code duplication,
         // we back those functions with a single internal function templated on the type of Locator.
@@ -186,6 +243,9 @@ class inventory : public visitable<inventory>
 
         invstack items;
         bool sorted;
+        mutable std::shared_ptr<const inventory_index> index;
+        /** Totals of the nearby items that are counted but not held, see @ref form_index_from_map. */
+        std::shared_ptr<const inventory_index> uncopied;
 };
 
 #endif
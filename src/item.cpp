@@ -2617,9 +2617,12 @@ void item::unset_flags()
 
 bool item::has_flag( const std::string &f ) const
 {
-    bool ret = false;
+    return has_flag( flag_set::id( f ) );
+}
 
-    if( json_flag::get( f ).inherit() ) {
+bool item::has_flag( const int f ) const
+{
+    if( json_flag::inherit( f ) ) {
         for( const auto e : is_gun() ? gunmods() : toolmods() ) {
             // gunmods fired separately do not contribute to base gun flags
             if( !e->is_gun() && e->has_flag( f ) ) {
@@ -2629,14 +2632,12 @@ bool item::has_flag( const std::string &f ) const
     }
 
     // other item type flags
-    ret = type->item_tags.count(f);
-    if (ret) {
-        return ret;
+    if( type->item_flags.count( f ) ) {
+        return true;
     }
 
     // now check for item specific flags
-    ret = item_tags.count(f);
-    return ret;
+    return !item_tags.empty() && item_tags.count( flag_set::name( f ) );
 }
 
 bool item::has_any_flag( const std::vector<std::string>& flags ) const
@@ -990,6 +990,8 @@ public:
          */
         /*@{*/
         bool has_flag( const std::string& flag ) const;
+        /** Same as above, for frequent checks. @param flag Interned id from @ref flag_set::id */
+        bool has_flag( int flag ) const;
         bool has_any_flag( const std::vector<std::string>& flags ) const;
         /** Removes all item specific flags. */
         void unset_flags();
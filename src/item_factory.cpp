@@ -266,6 +266,8 @@ void Item_factory::finalize() {
         for( auto &e : obj.use_methods ) {
             e.second.get_actor_ptr()->finalize( obj.id );
         }
+
+        obj.item_flags = flag_set( obj.item_tags );
     }
 }
 
@@ -867,6 +869,7 @@ void Item_factory::add_item_type(itype *new_type)
         debugmsg( "called Item_factory::add_item_type with nullptr" );
         return;
     }
+    new_type->item_flags = flag_set( new_type->item_tags );
     m_templates[ new_type->id ].reset( new_type );
 }
 
@@ -13,6 +13,7 @@
 #include "emit.h"
 #include "units.h"
 #include "damage.h"
+#include "flag.h"
 
 #include <string>
 #include <vector>
@@ -634,6 +635,8 @@ public:
     std::set<emit_id> emits;
 
     std::set<std::string> item_tags;
+    /** Same as @ref item_tags, filled in when the type is finalized or added at runtime. */
+    flag_set item_flags;
     std::set<matec_id> techniques;
 
     // Minimum stat(s) or skill(s) to use the item
@@ -74,12 +74,19 @@ JsonObject::JsonObject(JsonIn &j) : positions()
     while (!jsin->end_object()) {
         std::string n = jsin->get_member_name();
         int p = jsin->tell();
-        if (n != "//" && n != "comment" && positions.count(n) > 0) {
+        auto iter = std::find_if( positions.begin(), positions.end(),
+        [&n]( const std::pair<std::string, int> &member ) {
+            return member.first == n;
+        } );
+        if( iter == positions.end() ) {
+            positions.emplace_back( n, p );
+        } else if (n != "//" && n != "comment") {
             // members with name "//" or "comment" are used for comments and
             // should be ignored anyway.
             j.error("duplicate entry in json object");
+        } else {
+            iter->second = p;
         }
-        positions[n] = p;
         jsin->skip_value();
     }
     end = jsin->tell();
@@ -115,7 +122,7 @@ bool JsonObject::empty()
 int JsonObject::verify_position(const std::string &name,
                                 const bool throw_exception)
 {
-    int pos = positions[name]; // initialized to 0 if it doesn't exist
+    int pos = position_of( name ); // 0 if it doesn't exist
     if (pos > start) {
         return pos;
     } else if (throw_exception && !jsin) {
@@ -202,7 +209,7 @@ bool JsonObject::get_bool(const std::string &name)
 
 bool JsonObject::get_bool(const std::string &name, const bool fallback)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return fallback;
     }
@@ -219,7 +226,7 @@ int JsonObject::get_int(const std::string &name)
 
 int JsonObject::get_int(const std::string &name, const int fallback)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return fallback;
     }
@@ -236,7 +243,7 @@ long JsonObject::get_long(const std::string &name)
 
 long JsonObject::get_long(const std::string &name, const long fallback)
 {
-    long pos = positions[name];
+    long pos = position_of( name );
     if (pos <= start) {
         return fallback;
     }
@@ -253,7 +260,7 @@ double JsonObject::get_float(const std::string &name)
 
 double JsonObject::get_float(const std::string &name, const double fallback)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return fallback;
     }
@@ -270,7 +277,7 @@ std::string JsonObject::get_string(const std::string &name)
 
 std::string JsonObject::get_string(const std::string &name, const std::string &fallback)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return fallback;
     }
@@ -282,7 +289,7 @@ std::string JsonObject::get_string(const std::string &name, const std::string &f
 
 JsonArray JsonObject::get_array(const std::string &name)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return JsonArray(); // empty array
     }
@@ -312,7 +319,7 @@ std::vector<std::string> JsonObject::get_string_array(const std::string &name)
 
 JsonObject JsonObject::get_object(const std::string &name)
 {
-    int pos = positions[name];
+    int pos = position_of( name );
     if (pos <= start) {
         return JsonObject(); // empty object
     }
@@ -696,41 +703,120 @@ bool JsonArray::has_object(int i)
  * allowing easy extraction into c++ datatypes.
  */
 JsonIn::JsonIn(std::istream &s, bool strict) :
-    stream(&s), strict(strict), ate_separator(false)
+    source(&s), stream(nullptr, 0), strict(strict), ate_separator(false)
+{
+    const long start = s.tellg();
+    contents.assign( std::istreambuf_iterator<char>( s ), std::istreambuf_iterator<char>() );
+    stream = JsonInBuffer( contents.data(), contents.size(), std::max( start, 0L ) );
+    stream.setstate( !s.good() && contents.empty(), s.fail() && contents.empty() );
+}
+
+JsonIn::JsonIn( const char *data, size_t size, bool strict ) :
+    stream( data, size ), strict( strict ), ate_separator( false )
+{
+}
+
+JsonIn::~JsonIn()
+{
+    if( source == nullptr ) {
+        return;
+    }
+    // Leave the stream where parsing stopped, as if it had been read directly.
+    const bool eof = stream.eof();
+    const bool fail = stream.fail();
+    stream.clear();
+    const long pos = stream.tellg();
+    source->clear();
+    if( pos >= 0 && pos != stream.begin() + static_cast<long>( contents.size() ) ) {
+        source->seekg( pos );
+    }
+    if( eof || fail ) {
+        source->setstate( ( eof ? std::ios_base::eofbit : std::ios_base::goodbit ) |
+                          ( fail ? std::ios_base::failbit : std::ios_base::goodbit ) );
+    }
+}
+
+JsonInBuffer &JsonInBuffer::get( char *s, size_t n )
+{
+    size_t count = 0;
+    if( good() ) {
+        while( count + 1 < n ) {
+            if( pos >= size ) {
+                eofbit = true;
+                break;
+            }
+            if( data[pos] == '\n' ) {
+                break;
+            }
+            s[count++] = data[pos++];
+        }
+    }
+    if( n > 0 ) {
+        s[count] = '\0';
+    }
+    if( count == 0 ) {
+        failbit = true;
+    }
+    return *this;
+}
+
+JsonInBuffer &JsonInBuffer::read( char *s, size_t n )
 {
+    if( !good() ) {
+        failbit = true;
+        return *this;
+    }
+    const size_t count = std::min( n, size - pos );
+    std::copy( data + pos, data + pos + count, s );
+    pos += count;
+    if( count < n ) {
+        eofbit = true;
+        failbit = true;
+    }
+    return *this;
+}
+
+size_t JsonInBuffer::plain_string_chars() const
+{
+    size_t n = pos;
+    while( n < size && data[n] != '"' && data[n] != '\\' &&
+           static_cast<unsigned char>( data[n] ) >= 0x20 ) {
+        n++;
+    }
+    return n - pos;
 }
 
 int JsonIn::tell()
 {
-    return stream->tellg();
+    return stream.tellg();
 }
 char JsonIn::peek()
 {
-    return (char)stream->peek();
+    return (char)stream.peek();
 }
 bool JsonIn::good()
 {
-    return stream->good();
+    return stream.good();
 }
 
 void JsonIn::seek(int pos)
 {
-    stream->clear();
-    stream->seekg(pos);
+    stream.clear();
+    stream.seekg(pos);
     ate_separator = false;
 }
 
 void JsonIn::eat_whitespace()
 {
     while (is_whitespace(peek())) {
-        stream->get();
+        stream.get();
     }
 }
 
 void JsonIn::uneat_whitespace()
 {
-    while (tell() > 0) {
-        stream->seekg(-1, std::istream::cur);
+    while (tell() > stream.begin()) {
+        stream.seekg(-1, std::istream::cur);
         if (!is_whitespace(peek())) {
             break;
         }
@@ -759,7 +845,7 @@ void JsonIn::skip_separator()
         if (strict && ate_separator) {
             error("duplicate separator");
         }
-        stream->get();
+        stream.get();
         ate_separator = true;
     } else if (ch == ']' || ch == '}' || ch == ':') {
         // okay
@@ -788,7 +874,7 @@ void JsonIn::skip_pair_separator()
 {
     char ch;
     eat_whitespace();
-    stream->get(ch);
+    stream.get(ch);
     if (ch != ':') {
         std::stringstream err;
         err << "expected pair separator ':', not '" << ch << "'";
@@ -803,16 +889,18 @@ void JsonIn::skip_string()
 {
     char ch;
     eat_whitespace();
-    stream->get(ch);
+    stream.get(ch);
     if (ch != '"') {
         std::stringstream err;
         err << "expecting string but found '" << ch << "'";
         error(err.str(), -1);
     }
-    while (stream->good()) {
-        stream->get(ch);
+    while (stream.good()) {
+        // skip everything that needs no special treatment at once
+        stream.advance( stream.plain_string_chars() );
+        stream.get(ch);
         if (ch == '\\') {
-            stream->get(ch);
+            stream.get(ch);
             continue;
         } else if (ch == '"') {
             break;
@@ -878,7 +966,7 @@ void JsonIn::skip_true()
 {
     char text[5];
     eat_whitespace();
-    stream->get(text, 5);
+    stream.get(text, 5);
     if (strcmp(text, "true") != 0) {
         std::stringstream err;
         err << "expected \"true\", but found \"" << text << "\"";
@@ -891,7 +979,7 @@ void JsonIn::skip_false()
 {
     char text[6];
     eat_whitespace();
-    stream->get(text, 6);
+    stream.get(text, 6);
     if (strcmp(text, "false") != 0) {
         std::stringstream err;
         err << "expected \"false\", but found \"" << text << "\"";
@@ -904,7 +992,7 @@ void JsonIn::skip_null()
 {
     char text[5];
     eat_whitespace();
-    stream->get(text, 5);
+    stream.get(text, 5);
     if (strcmp(text, "null") != 0) {
         std::stringstream err;
         err << "expected \"null\", but found \"" << text << "\"";
@@ -918,11 +1006,11 @@ void JsonIn::skip_number()
     char ch;
     eat_whitespace();
     // skip all of (+-0123456789.eE)
-    while (stream->good()) {
-        stream->get(ch);
+    while (stream.good()) {
+        stream.get(ch);
         if (ch != '+' && ch != '-' && (ch < '0' || ch > '9') &&
             ch != 'e' && ch != 'E' && ch != '.') {
-            stream->unget();
+            stream.unget();
             break;
         }
     }
@@ -945,7 +1033,7 @@ std::string JsonIn::get_string()
     eat_whitespace();
     int startpos = tell();
     // the first character had better be a '"'
-    stream->get(ch);
+    stream.get(ch);
     if (ch != '"') {
         std::stringstream err;
         err << "expecting string but got '" << ch << "'";
@@ -953,8 +1041,14 @@ std::string JsonIn::get_string()
     }
     // add chars to the string, one at a time, converting:
     // \", \\, \/, \b, \f, \n, \r, \t and \uxxxx according to JSON spec.
-    while (stream->good()) {
-        stream->get(ch);
+    while (stream.good()) {
+        if (!backslash) {
+            // copy everything that needs no conversion or checks at once
+            const size_t plain = stream.plain_string_chars();
+            s.append( stream.current(), plain );
+            stream.advance( plain );
+        }
+        stream.get(ch);
         if (ch == '\\') {
             if (backslash) {
                 s += '\\';
@@ -981,7 +1075,7 @@ std::string JsonIn::get_string()
                 s += '\t';
             } else if (ch == 'u') {
                 // get the next four characters as hexadecimal
-                stream->get(unihex, 5);
+                stream.get(unihex, 5);
                 // insert the appropriate unicode character in utf8
                 // TODO: verify that unihex is in fact 4 hex digits.
                 char **endptr = 0;
@@ -1008,11 +1102,11 @@ std::string JsonIn::get_string()
         }
     }
     // if we get to here, probably hit a premature EOF?
-    if (stream->eof()) {
-        stream->clear();
+    if (stream.eof()) {
+        stream.clear();
         seek(startpos);
         error("couldn't find end of string, reached EOF.");
-    } else if (stream->fail()) {
+    } else if (stream.fail()) {
         throw JsonError( "stream failure while reading string." );
     }
     throw JsonError( "something went wrong D:" );
@@ -1041,10 +1135,10 @@ double JsonIn::get_float()
     int e = 0;
     int mod_e = 0;
     eat_whitespace();
-    stream->get(ch);
+    stream.get(ch);
     if (ch == '-') {
         neg = true;
-        stream->get(ch);
+        stream.get(ch);
     } else if (ch != '.' && (ch < '0' || ch > '9')) {
         // not a valid float
         std::stringstream err;
@@ -1053,7 +1147,7 @@ double JsonIn::get_float()
     }
     if (strict && ch == '0') {
         // allow a single leading zero in front of a '.' or 'e'/'E'
-        stream->get(ch);
+        stream.get(ch);
         if (ch >= '0' && ch <= '9') {
             error("leading zeros not strictly allowed", -1);
         }
@@ -1061,40 +1155,40 @@ double JsonIn::get_float()
     while (ch >= '0' && ch <= '9') {
         i *= 10;
         i += (ch - '0');
-        stream->get(ch);
+        stream.get(ch);
     }
     if (ch == '.') {
-        stream->get(ch);
+        stream.get(ch);
         while (ch >= '0' && ch <= '9') {
             i *= 10;
             i += (ch - '0');
             mod_e -= 1;
-            stream->get(ch);
+            stream.get(ch);
         }
     }
     if (neg) {
         i *= -1;
     }
     if (ch == 'e' || ch == 'E') {
-        stream->get(ch);
+        stream.get(ch);
         neg = false;
         if (ch == '-') {
             neg = true;
-            stream->get(ch);
+            stream.get(ch);
         } else if (ch == '+') {
-            stream->get(ch);
+            stream.get(ch);
         }
         while (ch >= '0' && ch <= '9') {
             e *= 10;
             e += (ch - '0');
-            stream->get(ch);
+            stream.get(ch);
         }
         if (neg) {
             e *= -1;
         }
     }
     // unget the final non-number character (probably a separator)
-    stream->unget();
+    stream.unget();
     end_value();
     // now put it all together!
     return i * std::pow(10.0f, e + mod_e);
@@ -1106,9 +1200,9 @@ bool JsonIn::get_bool()
     char text[5];
     std::stringstream err;
     eat_whitespace();
-    stream->get(ch);
+    stream.get(ch);
     if (ch == 't') {
-        stream->get(text, 4);
+        stream.get(text, 4);
         if (strcmp(text, "rue") == 0) {
             end_value();
             return true;
@@ -1118,7 +1212,7 @@ bool JsonIn::get_bool()
             error(err.str(), -4);
         }
     } else if (ch == 'f') {
-        stream->get(text, 5);
+        stream.get(text, 5);
         if (strcmp(text, "alse") == 0) {
             end_value();
             return false;
@@ -1146,7 +1240,7 @@ void JsonIn::start_array()
 {
     eat_whitespace();
     if (peek() == '[') {
-        stream->get();
+        stream.get();
         ate_separator = false;
         return;
     } else {
@@ -1166,7 +1260,7 @@ bool JsonIn::end_array()
             uneat_whitespace();
             error("separator not strictly allowed at end of array");
         }
-        stream->get();
+        stream.get();
         end_value();
         return true;
     } else {
@@ -1179,7 +1273,7 @@ void JsonIn::start_object()
 {
     eat_whitespace();
     if (peek() == '{') {
-        stream->get();
+        stream.get();
         ate_separator = false; // not that we want to
         return;
     } else {
@@ -1199,7 +1293,7 @@ bool JsonIn::end_object()
             uneat_whitespace();
             error("separator not strictly allowed at end of object");
         }
-        stream->get();
+        stream.get();
         end_value();
         return true;
     } else {
@@ -1429,23 +1523,23 @@ bool JsonIn::read(JsonDeserializer &j)
 // WARNING: for occasional use only.
 std::string JsonIn::line_number(int offset_modifier)
 {
-    if (stream->eof()) {
+    if (stream.eof()) {
         return "EOF";
-    } else if (stream->fail()) {
+    } else if (stream.fail()) {
         return "???";
     } // else stream is fine
     int pos = tell();
     int line = 1;
     int offset = 1;
     char ch;
-    seek(0);
-    for (int i = 0; i < pos; ++i) {
-        stream->get(ch);
+    seek(stream.begin());
+    for (int i = stream.begin(); i < pos; ++i) {
+        stream.get(ch);
         if (ch == '\r') {
             offset = 1;
             ++line;
             if (peek() == '\n') {
-                stream->get();
+                stream.get();
                 ++i;
             }
         } else if (ch == '\n') {
@@ -1465,17 +1559,17 @@ void JsonIn::error(std::string message, int offset)
     std::ostringstream err;
     err << line_number(offset) << ": " << message;
     // if we can't get more info from the stream don't try
-    if (!stream->good()) {
+    if (!stream.good()) {
         throw JsonError( err.str() );
     }
     // also print surrounding few lines of context, if not too large
     err << "\n\n";
-    stream->seekg(offset, std::istream::cur);
+    stream.seekg(offset, std::istream::cur);
     size_t pos = tell();
     rewind(3, 240);
     size_t startpos = tell();
     std::string buffer( pos - startpos, '\0' );
-    stream->read( &buffer[0], pos - startpos );
+    stream.read( &buffer[0], pos - startpos );
     err << buffer;
     if (!is_whitespace(peek())) {
         err << peek();
@@ -1490,10 +1584,10 @@ void JsonIn::error(std::string message, int offset)
     err << "^\n";
     seek(pos);
     // if that wasn't the end of the line, continue underneath pointer
-    char ch = stream->get();
+    char ch = stream.get();
     if (ch == '\r') {
         if (peek() == '\n') {
-            stream->get();
+            stream.get();
         }
     } else if (ch == '\n') {
         // pass
@@ -1505,12 +1599,12 @@ void JsonIn::error(std::string message, int offset)
     // print the next couple lines as well
     int line_count = 0;
     for (int i = 0; i < 240; ++i) {
-        stream->get(ch);
+        stream.get(ch);
         err << ch;
         if (ch == '\r') {
             ++line_count;
             if (peek() == '\n') {
-                err << stream->get();
+                err << stream.get();
             }
         } else if (ch == '\n') {
             ++line_count;
@@ -1526,20 +1620,20 @@ void JsonIn::rewind(int max_lines, int max_chars)
 {
     if (max_lines < 0 && max_chars < 0) {
         // just rewind to the beginning i guess
-        seek(0);
+        seek(stream.begin());
         return;
     }
-    if (tell() == 0) {
+    if (tell() == stream.begin()) {
         return;
     }
     int lines_found = 0;
-    stream->seekg(-1, std::istream::cur);
+    stream.seekg(-1, std::istream::cur);
     for (int i = 0; i < max_chars; ++i) {
         size_t tellpos = tell();
         if (peek() == '\n') {
             ++lines_found;
-            if (tellpos > 0) {
-                stream->seekg(-1, std::istream::cur);
+            if (tellpos > size_t(stream.begin())) {
+                stream.seekg(-1, std::istream::cur);
                 // note: does not update tellpos or count a character
                 if (peek() != '\r') {
                     continue;
@@ -1548,14 +1642,14 @@ void JsonIn::rewind(int max_lines, int max_chars)
         } else if (peek() == '\r') {
             ++lines_found;
         }
-        if (tellpos == 0) {
+        if (tellpos == size_t(stream.begin())) {
             break;
         } else if (lines_found == max_lines) {
             // don't include the last \n or \r
-            stream->seekg(1, std::istream::cur);
+            stream.seekg(1, std::istream::cur);
             break;
         }
-        stream->seekg(-1, std::istream::cur);
+        stream.seekg(-1, std::istream::cur);
     }
 }
 
@@ -1563,13 +1657,13 @@ std::string JsonIn::substr(size_t pos, size_t len)
 {
     std::string ret;
     if (len == std::string::npos) {
-        stream->seekg(0, std::istream::end);
+        stream.seekg(0, std::istream::end);
         size_t end = tell();
         len = end - pos;
     }
     ret.resize(len);
-    stream->seekg(pos);
-    stream->read(&ret[0], len);
+    stream.seekg(pos);
+    stream.read(&ret[0], len);
     return ret;
 }
 
@@ -2,6 +2,7 @@
 #define JSON_H
 
 #include <type_traits>
+#include <ios>
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -157,10 +158,138 @@ inline E string_to_enum_look_up( const C &container, const std::string &data )
  * If an if;else if;... is missing the "else", it /will/ cause bugs,
  * so preindexing as a JsonObject is safer, as well as tidier.
  */
+/**
+ * The part of the std::istream interface that JsonIn needs, over data in memory. The
+ * state flags behave the same as those of an istream (bad is folded into fail), but
+ * reading a character is just an index increment.
+ * Positions start at the given base, so they match the ones of the stream the data
+ * came from.
+ */
+class JsonInBuffer
+{
+    private:
+        const char *data;
+        size_t size;
+        size_t pos = 0;
+        long base;
+        bool eofbit = false;
+        bool failbit = false;
+
+    public:
+        JsonInBuffer( const char *data, size_t size, long base = 0 ) :
+            data( data ), size( size ), base( base ) {}
+
+        bool good() const {
+            return !eofbit && !failbit;
+        }
+        bool eof() const {
+            return eofbit;
+        }
+        bool fail() const {
+            return failbit;
+        }
+        void clear() {
+            eofbit = false;
+            failbit = false;
+        }
+        void setstate( bool eof, bool fail ) {
+            eofbit = eofbit || eof;
+            failbit = failbit || fail;
+        }
+
+        int peek() {
+            if( !good() ) {
+                return std::char_traits<char>::eof();
+            }
+            if( pos >= size ) {
+                eofbit = true;
+                return std::char_traits<char>::eof();
+            }
+            return static_cast<unsigned char>( data[pos] );
+        }
+        int get() {
+            if( !good() ) {
+                failbit = true;
+                return std::char_traits<char>::eof();
+            }
+            if( pos >= size ) {
+                eofbit = true;
+                failbit = true;
+                return std::char_traits<char>::eof();
+            }
+            return static_cast<unsigned char>( data[pos++] );
+        }
+        JsonInBuffer &get( char &ch ) {
+            const int c = get();
+            if( c != std::char_traits<char>::eof() ) {
+                ch = static_cast<char>( c );
+            }
+            return *this;
+        }
+        /** Like istream::get(char*, streamsize): stops before a newline, always terminates. */
+        JsonInBuffer &get( char *s, size_t n );
+        JsonInBuffer &read( char *s, size_t n );
+        void unget() {
+            eofbit = false;
+            if( failbit ) {
+                return;
+            }
+            if( pos == 0 ) {
+                failbit = true;
+                return;
+            }
+            pos--;
+        }
+
+        long tellg() const {
+            return failbit ? -1 : base + static_cast<long>( pos );
+        }
+        void seekg( long p ) {
+            eofbit = false;
+            if( failbit ) {
+                return;
+            }
+            if( p < base || p - base > static_cast<long>( size ) ) {
+                failbit = true;
+                return;
+            }
+            pos = p - base;
+        }
+        void seekg( long off, std::ios_base::seekdir dir ) {
+            if( dir == std::ios_base::beg ) {
+                seekg( base + off );
+            } else if( dir == std::ios_base::cur ) {
+                seekg( base + static_cast<long>( pos ) + off );
+            } else {
+                seekg( base + static_cast<long>( size ) + off );
+            }
+        }
+        /** Position of the first character. */
+        long begin() const {
+            return base;
+        }
+
+        /**
+         * Number of characters from the current one on that can be taken as they are
+         * inside a string: anything but quotes, backslashes and control characters.
+         */
+        size_t plain_string_chars() const;
+        const char *current() const {
+            return data + pos;
+        }
+        void advance( size_t n ) {
+            pos += n;
+        }
+};
+
 class JsonIn
 {
     private:
-        std::istream *stream;
+        /** The stream this was constructed from, set back to where parsing stopped. */
+        std::istream *source = nullptr;
+        /** The rest of the source stream. */
+        std::string contents;
+        JsonInBuffer stream;
         bool strict; // throw errors on non-RFC-4627-compliant input
         bool ate_separator;
 
@@ -169,7 +298,14 @@ class JsonIn
         void end_value();
 
     public:
+        /** Reads the rest of the stream into memory. */
         JsonIn(std::istream &stream, bool strict = true);
+        /** Parses the data in place, it must outlive this object. */
+        JsonIn( const char *data, size_t size, bool strict = true );
+        ~JsonIn();
+
+        JsonIn( const JsonIn & ) = delete;
+        JsonIn &operator=( const JsonIn & ) = delete;
 
         bool get_ate_separator()
         {
@@ -599,13 +735,23 @@ class JsonOut
 class JsonObject
 {
     private:
-        std::map<std::string, int> positions;
+        /** Members and positions of their values, in the order of the file. */
+        std::vector<std::pair<std::string, int>> positions;
         int start;
         int end;
         bool final_separator;
         JsonIn *jsin;
         int verify_position(const std::string &name,
                             const bool throw_exception = true);
+        /** Position of the value of the member, 0 if there is no such member. */
+        int position_of( const std::string &name ) const {
+            for( const auto &member : positions ) {
+                if( member.first.size() == name.size() && member.first == name ) {
+                    return member.second;
+                }
+            }
+            return 0;
+        }
 
     public:
         JsonObject(JsonIn &jsin);
@@ -693,7 +839,7 @@ class JsonObject
         // return false if the member is not found.
         template <typename T> bool read(const std::string &name, T &t)
         {
-            int pos = positions[name];
+            int pos = position_of( name );
             if (pos <= start) {
                 return false;
             }
@@ -903,7 +1049,7 @@ template <typename T>
 std::set<T> JsonObject::get_tags( const std::string &name )
 {
     std::set<T> res;
-    int pos = positions[ name ];
+    int pos = position_of( name );
     if ( pos <= start ) {
         return res;
     }
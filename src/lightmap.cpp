@@ -50,84 +50,96 @@ void map::add_light_from_items( const tripoint &p, std::list<item>::iterator beg
 void map::build_transparency_cache( const int zlev )
 {
     auto &map_cache = get_cache( zlev );
-    auto &transparency_cache = map_cache.transparency_cache;
-    auto &outside_cache = map_cache.outside_cache;
+    auto &dirty_submaps = map_cache.transparency_dirty_submaps;
 
-    if( !map_cache.transparency_cache_dirty ) {
+    if( map_cache.transparency_cache_dirty ) {
+        dirty_submaps.set();
+    } else if( dirty_submaps.none() ) {
         return;
     }
 
-    // Default to just barely not transparent.
-    std::uninitialized_fill_n(
-        &transparency_cache[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, LIGHT_TRANSPARENCY_OPEN_AIR);
-
-    // Traverse the submaps in order
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+            if( dirty_submaps[smx + smy * MAPSIZE] ) {
+                build_transparency_cache_submap( map_cache, smx, smy, zlev );
+                // Whatever changed the transparency may have changed the light sources.
+                map_cache.light_source_dirty_submaps.set( smx + smy * MAPSIZE );
+            }
+        }
+    }
+    dirty_submaps.reset();
+    map_cache.transparency_cache_dirty = false;
+}
+
+void map::build_transparency_cache_submap( level_cache &map_cache, const int smx, const int smy,
+        const int zlev )
+{
+    auto &transparency_cache = map_cache.transparency_cache;
+    auto &outside_cache = map_cache.outside_cache;
+    auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+    const float sight_penalty = weather_data( g->weather ).sight_penalty;
 
-            for( int sx = 0; sx < SEEX; ++sx ) {
-                for( int sy = 0; sy < SEEY; ++sy ) {
-                    const int x = sx + smx * SEEX;
-                    const int y = sy + smy * SEEY;
+    for( int sx = 0; sx < SEEX; ++sx ) {
+        for( int sy = 0; sy < SEEY; ++sy ) {
+            const int x = sx + smx * SEEX;
+            const int y = sy + smy * SEEY;
 
-                    auto &value = transparency_cache[x][y];
+            auto &value = transparency_cache[x][y];
+            // Default to just barely not transparent.
+            value = LIGHT_TRANSPARENCY_OPEN_AIR;
 
-                    if( !(cur_submap->ter[sx][sy].obj().transparent &&
-                          cur_submap->frn[sx][sy].obj().transparent) ) {
-                        value = LIGHT_TRANSPARENCY_SOLID;
-                        continue;
-                    }
+            if( !(cur_submap->ter[sx][sy].obj().transparent &&
+                  cur_submap->frn[sx][sy].obj().transparent) ) {
+                value = LIGHT_TRANSPARENCY_SOLID;
+                continue;
+            }
 
-                    if( outside_cache[x][y] ) {
-                        value *= weather_data(g->weather).sight_penalty;
-                    }
+            if( outside_cache[x][y] ) {
+                value *= sight_penalty;
+            }
+
+            for( auto const &fld : cur_submap->fld[sx][sy] ) {
+                const field_entry &cur = fld.second;
+                const field_id type = cur.getFieldType();
+                const int density = cur.getFieldDensity();
+
+                if( fieldlist[type].transparent[density - 1] ) {
+                    continue;
+                }
 
-                    for( auto const &fld : cur_submap->fld[sx][sy] ) {
-                        const field_entry &cur = fld.second;
-                        const field_id type = cur.getFieldType();
-                        const int density = cur.getFieldDensity();
-
-                        if( fieldlist[type].transparent[density - 1] ) {
-                            continue;
-                        }
-
-                        // Fields are either transparent or not, however we want some to be translucent
-                        switch (type) {
-                        case fd_cigsmoke:
-                        case fd_weedsmoke:
-                        case fd_cracksmoke:
-                        case fd_methsmoke:
-                        case fd_relax_gas:
-                            value *= 5;
-                            break;
-                        case fd_smoke:
-                        case fd_incendiary:
-                        case fd_toxic_gas:
-                        case fd_tear_gas:
-                            if (density == 3) {
-                                value = LIGHT_TRANSPARENCY_SOLID;
-                            } else if (density == 2) {
-                                value *= 10;
-                            }
-                            break;
-                        case fd_nuke_gas:
-                            value *= 10;
-                            break;
-                        case fd_fire:
-                            value *= 1.0 - ( density * 0.3 );
-                            break;
-                        default:
-                            value = LIGHT_TRANSPARENCY_SOLID;
-                            break;
-                        }
-                        // TODO: [lightmap] Have glass reduce light as well
+                // Fields are either transparent or not, however we want some to be translucent
+                switch (type) {
+                case fd_cigsmoke:
+                case fd_weedsmoke:
+                case fd_cracksmoke:
+                case fd_methsmoke:
+                case fd_relax_gas:
+                    value *= 5;
+                    break;
+                case fd_smoke:
+                case fd_incendiary:
+                case fd_toxic_gas:
+                case fd_tear_gas:
+                    if (density == 3) {
+                        value = LIGHT_TRANSPARENCY_SOLID;
+                    } else if (density == 2) {
+                        value *= 10;
                     }
+                    break;
+                case fd_nuke_gas:
+                    value *= 10;
+                    break;
+                case fd_fire:
+                    value *= 1.0 - ( density * 0.3 );
+                    break;
+                default:
+                    value = LIGHT_TRANSPARENCY_SOLID;
+                    break;
                 }
+                // TODO: [lightmap] Have glass reduce light as well
             }
         }
     }
-    map_cache.transparency_cache_dirty = false;
 }
 
 void map::apply_character_light( player &p )
@@ -148,13 +160,126 @@ void map::apply_character_light( player &p )
     }
 }
 
+// Light given off by terrain, zero for most of it.
+static float terrain_light( const ter_id terrain )
+{
+    if( terrain == t_lava ) {
+        return 50;
+    } else if( terrain == t_console ) {
+        return 10;
+    } else if( terrain == t_utility_light ) {
+        return 240;
+    }
+    return 0;
+}
+
+constexpr int dir_x[] = {  0, -1 , 1, 0 };   //    [0]
+constexpr int dir_y[] = { -1,  0 , 0, 1 };   // [1][X][2]
+constexpr int dir_d[] = { 90, 0, 180, 270 }; //    [3]
+
+void map::build_light_sources_submap( level_cache &ch, const int smx, const int smy,
+                                      const int zlev )
+{
+    const auto &outside_cache = ch.outside_cache;
+    auto &tiles = ch.light_source_tiles[smx + smy * MAPSIZE];
+    auto &openings = ch.sunlight_openings[smx + smy * MAPSIZE];
+    tiles.clear();
+    openings.clear();
+    auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+
+    for( int sx = 0; sx < SEEX; ++sx ) {
+        for( int sy = 0; sy < SEEY; ++sy ) {
+            const int x = sx + smx * SEEX;
+            const int y = sy + smy * SEEY;
+            if( !outside_cache[x][y] ) {
+                for( int i = 0; i < 4; ++i ) {
+                    if( INBOUNDS( x + dir_x[i], y + dir_y[i] ) &&
+                        outside_cache[x + dir_x[i]][y + dir_y[i]] ) {
+                        openings.emplace_back( point( x, y ), i );
+                    }
+                }
+            }
+            // Fields are listed even if they give off no light, they change too often to
+            // keep track of their type here.
+            if( cur_submap->lum[sx][sy] || terrain_light( cur_submap->ter[sx][sy] ) > 0 ||
+                cur_submap->fld[sx][sy].fieldCount() > 0 ) {
+                tiles.emplace_back( x, y );
+            }
+        }
+    }
+}
+
+void map::add_light_from_tile( const submap &sm, const int sx, const int sy, const tripoint &p )
+{
+    if( sm.lum[sx][sy] && has_items( p ) ) {
+        auto items = i_at( p );
+        add_light_from_items( p, items.begin(), items.end() );
+    }
+
+    const float terrain_luminance = terrain_light( sm.ter[sx][sy] );
+    if( terrain_luminance > 0 ) {
+        add_light_source( p, terrain_luminance );
+    }
+
+    for( auto &fld : sm.fld[sx][sy] ) {
+        const field_entry *cur = &fld.second;
+        // TODO: [lightmap] Attach light brightness to fields
+        switch(cur->getFieldType()) {
+        case fd_fire:
+            if (3 == cur->getFieldDensity()) {
+                add_light_source( p, 160 );
+            } else if (2 == cur->getFieldDensity()) {
+                add_light_source( p, 60 );
+            } else {
+                add_light_source( p, 20 );
+            }
+            break;
+        case fd_fire_vent:
+        case fd_flame_burst:
+            add_light_source( p, 20 );
+            break;
+        case fd_electricity:
+        case fd_plasma:
+            if (3 == cur->getFieldDensity()) {
+                add_light_source( p, 20 );
+            } else if (2 == cur->getFieldDensity()) {
+                add_light_source( p, 4 );
+            } else {
+                // Kinda a hack as the square will still get marked.
+                apply_light_source( p, LIGHT_SOURCE_LOCAL );
+            }
+            break;
+        case fd_incendiary:
+            if (3 == cur->getFieldDensity()) {
+                add_light_source( p, 160 );
+            } else if (2 == cur->getFieldDensity()) {
+                add_light_source( p, 60 );
+            } else {
+                add_light_source( p, 20 );
+            }
+            break;
+        case fd_laser:
+            apply_light_source( p, 4 );
+            break;
+        case fd_spotlight:
+            add_light_source( p, 80 );
+            break;
+        case fd_dazzling:
+            add_light_source( p, 5 );
+            break;
+        default:
+            //Suppress warnings
+            break;
+        }
+    }
+}
+
 void map::generate_lightmap( const int zlev )
 {
     auto &map_cache = get_cache( zlev );
     auto &lm = map_cache.lm;
     auto &sm = map_cache.sm;
     auto &outside_cache = map_cache.outside_cache;
-    std::memset(lm, 0, sizeof(lm));
     std::memset(sm, 0, sizeof(sm));
 
     /* Bulk light sources wastefully cast rays into neighbors; a burning hospital can produce
@@ -167,11 +292,7 @@ void map::generate_lightmap( const int zlev )
      * Step 4: Profit!
      */
     auto &light_source_buffer = map_cache.light_source_buffer;
-    std::memset(light_source_buffer, 0, sizeof(light_source_buffer));
-
-    constexpr int dir_x[] = {  0, -1 , 1, 0 };   //    [0]
-    constexpr int dir_y[] = { -1,  0 , 0, 1 };   // [1][X][2]
-    constexpr int dir_d[] = { 90, 0, 180, 270 }; //    [3]
+    auto &light_source_points = map_cache.light_source_points;
 
     const float natural_light  = g->natural_light_level( zlev );
     const float inside_light = (natural_light > LIGHT_SOURCE_BRIGHT) ?
@@ -193,101 +314,42 @@ void map::generate_lightmap( const int zlev )
         apply_character_light( *n );
     }
 
-    // Traverse the submaps in order
-    for (int smx = 0; smx < my_MAPSIZE; ++smx) {
-        for (int smy = 0; smy < my_MAPSIZE; ++smy) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
-
-            for (int sx = 0; sx < SEEX; ++sx) {
-                for (int sy = 0; sy < SEEY; ++sy) {
-                    const int x = sx + smx * SEEX;
-                    const int y = sy + smy * SEEY;
-                    const tripoint p( x, y, zlev );
-                    // Project light into any openings into buildings.
-                    if (natural_light > LIGHT_SOURCE_BRIGHT && !outside_cache[p.x][p.y]) {
-                        // Apply light sources for external/internal divide
-                        for(int i = 0; i < 4; ++i) {
-                            if (INBOUNDS(p.x + dir_x[i], p.y + dir_y[i]) &&
-                                outside_cache[p.x + dir_x[i]][p.y + dir_y[i]]) {
-                                lm[p.x][p.y] = natural_light;
-
-                                if (light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID) {
-                                    apply_directional_light( p, dir_d[i], natural_light );
-                                }
-                            }
-                        }
-                    }
-
-                    if( cur_submap->lum[sx][sy] && has_items( p ) ) {
-                        auto items = i_at( p );
-                        add_light_from_items( p, items.begin(), items.end() );
-                    }
-
-                    const ter_id terrain = cur_submap->ter[sx][sy];
-                    if (terrain == t_lava) {
-                        add_light_source( p, 50 );
-                    } else if (terrain == t_console) {
-                        add_light_source( p, 10 );
-                    } else if (terrain == t_utility_light) {
-                        add_light_source( p, 240 );
-                    }
-
-                    for( auto &fld : cur_submap->fld[sx][sy] ) {
-                        const field_entry *cur = &fld.second;
-                        // TODO: [lightmap] Attach light brightness to fields
-                        switch(cur->getFieldType()) {
-                        case fd_fire:
-                            if (3 == cur->getFieldDensity()) {
-                                add_light_source( p, 160 );
-                            } else if (2 == cur->getFieldDensity()) {
-                                add_light_source( p, 60 );
-                            } else {
-                                add_light_source( p, 20 );
-                            }
-                            break;
-                        case fd_fire_vent:
-                        case fd_flame_burst:
-                            add_light_source( p, 20 );
-                            break;
-                        case fd_electricity:
-                        case fd_plasma:
-                            if (3 == cur->getFieldDensity()) {
-                                add_light_source( p, 20 );
-                            } else if (2 == cur->getFieldDensity()) {
-                                add_light_source( p, 4 );
-                            } else {
-                                // Kinda a hack as the square will still get marked.
-                                apply_light_source( p, LIGHT_SOURCE_LOCAL );
-                            }
-                            break;
-                        case fd_incendiary:
-                            if (3 == cur->getFieldDensity()) {
-                                add_light_source( p, 160 );
-                            } else if (2 == cur->getFieldDensity()) {
-                                add_light_source( p, 60 );
-                            } else {
-                                add_light_source( p, 20 );
-                            }
-                            break;
-                        case fd_laser:
-                            apply_light_source( p, 4 );
-                            break;
-                        case fd_spotlight:
-                            add_light_source( p, 80 );
-                            break;
-                        case fd_dazzling:
-                            add_light_source( p, 5 );
-                            break;
-                        default:
-                            //Suppress warnings
-                            break;
-                        }
+    // Only the listed tiles of each submap can give off light.
+    for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
+        for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( map_cache.light_source_dirty_submaps[smx + smy * MAPSIZE] ) {
+                build_light_sources_submap( map_cache, smx, smy, zlev );
+            }
+        }
+    }
+    map_cache.light_source_dirty_submaps.reset();
+
+    // Project light into any openings into buildings.
+    if( natural_light > LIGHT_SOURCE_BRIGHT ) {
+        for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
+            for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+                for( const auto &opening : map_cache.sunlight_openings[smx + smy * MAPSIZE] ) {
+                    // Apply light sources for external/internal divide
+                    const tripoint p( opening.first, zlev );
+                    lm[p.x][p.y] = natural_light;
+                    if( light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID ) {
+                        apply_directional_light( p, dir_d[opening.second], natural_light );
                     }
                 }
             }
         }
     }
 
+    for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
+        for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+            for( const point &pt : map_cache.light_source_tiles[smx + smy * MAPSIZE] ) {
+                add_light_from_tile( *cur_submap, pt.x - smx * SEEX, pt.y - smy * SEEY,
+                                     tripoint( pt, zlev ) );
+            }
+        }
+    }
+
     for (size_t i = 0; i < g->num_zombies(); ++i) {
         auto &critter = g->zombie(i);
         if(critter.is_hallucination()) {
@@ -369,13 +431,17 @@ void map::generate_lightmap( const int zlev )
         unbuffered: (12^2)*(160*4) = apply_light_ray x 92160
         buffered:   (12*4)*(160)   = apply_light_ray x 7680
     */
+    for( const point &pt : light_source_points ) {
+        apply_light_source( tripoint( pt, zlev ), light_source_buffer[pt.x][pt.y] );
+    }
+    // Cleared here instead of all of the buffer at the start.
+    for( const point &pt : light_source_points ) {
+        light_source_buffer[pt.x][pt.y] = 0.0f;
+    }
+    light_source_points.clear();
+
     const tripoint cache_start( 0, 0, zlev );
     const tripoint cache_end( LIGHTMAP_CACHE_X, LIGHTMAP_CACHE_Y, zlev );
-    for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
-        if( light_source_buffer[p.x][p.y] > 0.0 ) {
-            apply_light_source( p, light_source_buffer[p.x][p.y] );
-        }
-    }
 
 
     if (g->u.has_active_bionic("bio_night") ) {
@@ -389,7 +455,11 @@ void map::generate_lightmap( const int zlev )
 
 void map::add_light_source( const tripoint &p, float luminance )
 {
-    auto &light_source_buffer = get_cache( p.z ).light_source_buffer;
+    auto &map_cache = get_cache( p.z );
+    auto &light_source_buffer = map_cache.light_source_buffer;
+    if( light_source_buffer[p.x][p.y] <= 0.0f && luminance > 0.0f ) {
+        map_cache.light_source_points.emplace_back( p.x, p.y );
+    }
     light_source_buffer[p.x][p.y] = std::max(luminance, light_source_buffer[p.x][p.y]);
 }
 
@@ -195,6 +195,22 @@ void map::add_vehicle_to_cache( vehicle *veh )
 
     auto &ch = get_cache( veh->smz );
     ch.veh_in_active_range = true;
+    // Slot of the vehicle, it may already be cached or reuse the slot of a removed one.
+    size_t slot = 0;
+    while( slot < ch.cached_vehicles.size() && ch.cached_vehicles[slot].first != veh ) {
+        slot++;
+    }
+    if( slot == ch.cached_vehicles.size() ) {
+        slot = 0;
+        while( slot < ch.cached_vehicles.size() && ch.cached_vehicles[slot].first != nullptr ) {
+            slot++;
+        }
+        if( slot == ch.cached_vehicles.size() ) {
+            ch.cached_vehicles.emplace_back();
+        }
+        ch.cached_vehicles[slot].first = veh;
+    }
+    std::vector<point> &tiles = ch.cached_vehicles[slot].second;
     // Get parts
     std::vector<vehicle_part> &parts = veh->parts;
     const tripoint gpos = veh->global_pos3();
@@ -205,10 +221,12 @@ void map::add_vehicle_to_cache( vehicle *veh )
             continue;
         }
         const tripoint p = gpos + it->precalc[0];
-        ch.veh_cached_parts.insert( std::make_pair( p,
-                                    std::make_pair( veh, partid ) ) );
-        if( inbounds( p.x, p.y ) ) {
+        // The first part on a tile is the one that is found, as it has always been.
+        if( inbounds( p.x, p.y ) && !ch.veh_exists_at[p.x][p.y] ) {
             ch.veh_exists_at[p.x][p.y] = true;
+            ch.veh_cached_parts[p.x][p.y] = std::make_pair( static_cast<uint16_t>( slot ),
+                                            static_cast<uint16_t>( partid ) );
+            tiles.emplace_back( p.x, p.y );
         }
     }
 }
@@ -222,20 +240,18 @@ void map::update_vehicle_cache( vehicle *veh, const int old_zlevel )
 
     // Existing must be cleared
     auto &ch = get_cache( old_zlevel );
-    auto it = ch.veh_cached_parts.begin();
-    const auto end = ch.veh_cached_parts.end();
-    while( it != end ) {
-        if( it->second.first == veh ) {
-            const auto &p = it->first;
-            if( inbounds( p.x, p.y ) ) {
-                ch.veh_exists_at[p.x][p.y] = false;
-            }
-            ch.veh_cached_parts.erase( it++ );
+    for( auto &cached : ch.cached_vehicles ) {
+        if( cached.first != veh ) {
+            continue;
+        }
+        for( const point &p : cached.second ) {
+            ch.veh_exists_at[p.x][p.y] = false;
             // If something was resting on veh, drop it
             support_dirty( tripoint( p.x, p.y, old_zlevel + 1 ) );
-        } else {
-            ++it;
         }
+        cached.first = nullptr;
+        cached.second.clear();
+        break;
     }
 
     add_vehicle_to_cache( veh );
@@ -244,14 +260,12 @@ void map::update_vehicle_cache( vehicle *veh, const int old_zlevel )
 void map::clear_vehicle_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    while( !ch.veh_cached_parts.empty() ) {
-        const auto part = ch.veh_cached_parts.begin();
-        const auto &p = part->first;
-        if( inbounds( p ) ) {
+    for( const auto &cached : ch.cached_vehicles ) {
+        for( const point &p : cached.second ) {
             ch.veh_exists_at[p.x][p.y] = false;
         }
-        ch.veh_cached_parts.erase( part );
     }
+    ch.cached_vehicles.clear();
 }
 
 void map::clear_vehicle_list( const int zlev )
@@ -289,8 +303,10 @@ std::unique_ptr<vehicle> map::detach_vehicle( vehicle *veh )
         if (current_submap->vehicles[i] == veh) {
             const int zlev = veh->smz;
             ch.vehicle_list.erase(veh);
+            vehicle_order.erase( veh );
             reset_vehicle_cache( zlev );
             current_submap->vehicles.erase (current_submap->vehicles.begin() + i);
+            current_submap->is_dirty = true;
             if( veh->tracking_on ) {
                 overmap_buffer.remove_vehicle( veh );
             }
@@ -316,14 +332,19 @@ void map::on_vehicle_moved( const int smz ) {
 
 void map::vehmove()
 {
+    vehicle_queue = std::priority_queue<queued_vehicle>();
+    vehicle_order.clear();
     // give vehicles movement points
-    {
-        VehicleList vehs = get_vehicles();
-        for( auto &vehs_v : vehs ) {
-            vehicle *veh = vehs_v.v;
-            veh->gain_moves();
-            veh->slow_leak();
-        }
+    VehicleList vehs = get_vehicles();
+    for( auto &vehs_v : vehs ) {
+        vehicle *veh = vehs_v.v;
+        veh->gain_moves();
+        veh->slow_leak();
+    }
+    // Stationary vehicles stay out of the queue, unless they are hit by another one.
+    for( auto &vehs_v : vehs ) {
+        vehicle_order.emplace( vehs_v.v, vehicle_order.size() );
+        queue_vehicle( *vehs_v.v );
     }
 
     // 15 equals 3 >50mph vehicles, or up to 15 slow (1 square move) ones
@@ -333,6 +354,8 @@ void map::vehmove()
             break;
         }
     }
+    vehicle_queue = std::priority_queue<queued_vehicle>();
+    vehicle_order.clear();
     // Process item removal on the vehicles that were modified this turn.
     // Use a copy because part_removal_cleanup can modify the container.
     auto temp = dirty_vehicle_list;
@@ -342,22 +365,33 @@ void map::vehmove()
     dirty_vehicle_list.clear();
 }
 
+void map::queue_vehicle( vehicle &veh )
+{
+    if( veh.of_turn > 0 ) {
+        // Vehicles that were not there at the start of the turn go last.
+        const size_t order = vehicle_order.emplace( &veh, vehicle_order.size() ).first->second;
+        vehicle_queue.push( queued_vehicle{ veh.of_turn, order, &veh } );
+    }
+}
+
 bool map::vehproceed()
 {
-    VehicleList vehs = get_vehicles();
     vehicle* cur_veh = nullptr;
-    float max_of_turn = 0;
-    tripoint pt;
-    // First horizontal movement
-    for( auto &vehs_v : vehs ) {
-        if( vehs_v.v->of_turn > max_of_turn ) {
-            cur_veh = vehs_v.v;
-            max_of_turn = cur_veh->of_turn;
+    // First horizontal movement, the vehicle with the most of_turn
+    while( cur_veh == nullptr && !vehicle_queue.empty() ) {
+        const queued_vehicle top = vehicle_queue.top();
+        vehicle_queue.pop();
+        // Destroyed vehicles are removed from vehicle_order, the others may have been
+        // shifted out of the reality bubble.
+        if( vehicle_order.count( top.veh ) > 0 && top.veh->of_turn == top.of_turn &&
+            get_cache( top.veh->smz ).vehicle_list.count( top.veh ) > 0 ) {
+            cur_veh = top.veh;
         }
     }
 
     // Then vertical-only movement
     if( cur_veh == nullptr ) {
+        VehicleList vehs = get_vehicles();
         for( auto &vehs_v : vehs ) {
             vehicle &cveh = *vehs_v.v;
             if( cveh.falling ) {
@@ -371,7 +405,11 @@ bool map::vehproceed()
         return false;
     }
 
-    return vehact( *cur_veh );
+    const bool result = vehact( *cur_veh );
+    if( vehicle_order.count( cur_veh ) > 0 ) {
+        queue_vehicle( *cur_veh );
+    }
+    return result;
 }
 
 bool map::vehact( vehicle &veh )
@@ -999,6 +1037,10 @@ float map::vehicle_vehicle_collision( vehicle &veh, vehicle &veh2,
 
         veh.of_turn = avg_of_turn * .9;
         veh2.of_turn = avg_of_turn * 1.1;
+        // Only while in vehmove, veh is queued again when it's done moving.
+        if( !vehicle_order.empty() ) {
+            queue_vehicle( veh2 );
+        }
 
         //Energy after collision
         float E_a = 0.5 * m1 * final1.norm() * final1.norm() +
@@ -1132,10 +1174,13 @@ const vehicle* map::veh_at_internal( const tripoint &p, int &part_num ) const
         return nullptr; // Clear cache indicates no vehicle. This should optimize a great deal.
     }
 
-    const auto it = ch.veh_cached_parts.find( p );
-    if( it != ch.veh_cached_parts.end() ) {
-        part_num = it->second.second;
-        return it->second.first;
+    const auto &cached = ch.veh_cached_parts[p.x][p.y];
+    if( cached.first < ch.cached_vehicles.size() ) {
+        const vehicle *veh = ch.cached_vehicles[cached.first].first;
+        if( veh != nullptr && cached.second < veh->parts.size() ) {
+            part_num = cached.second;
+            return veh;
+        }
     }
 
     debugmsg( "vehicle part cache indicated vehicle not found: %d %d %d", p.x, p.y, p.z );
@@ -1372,6 +1417,8 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
         dst_submap->vehicles.push_back( veh );
         src_submap->vehicles.erase( src_submap->vehicles.begin() + our_i );
         dst_submap->is_uniform = false;
+        dst_submap->is_dirty = true;
+        src_submap->is_dirty = true;
     }
 
     p = p2;
@@ -1550,15 +1597,15 @@ void map::furn_set( const tripoint &p, const furn_id new_furniture )
     const furn_t &new_t = new_furniture.obj();
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_NO_FLOOR ) != new_t.has_flag( TFLAG_NO_FLOOR ) ) {
-        set_floor_cache_dirty( p.z );
+        set_floor_cache_dirty( p );
     }
 
     // @todo Limit to changes that affect move cost, traps and stairs
@@ -1700,6 +1747,9 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     const ter_t &old_t = old_id.obj();
     const ter_t &new_t = new_terrain.obj();
 
+    // Lava and lamps give off light.
+    set_light_source_dirty( p );
+
     // Hack around ledges in traplocs or else it gets NASTY in z-level mode
     if( old_t.trap != tr_null && old_t.trap != tr_ledge ) {
         auto &traps = traplocs[old_t.trap];
@@ -1713,15 +1763,15 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     }
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( new_t.has_flag( TFLAG_NO_FLOOR ) && !old_t.has_flag( TFLAG_NO_FLOOR ) ) {
-        set_floor_cache_dirty( p.z );
+        set_floor_cache_dirty( p );
         // It's a set, not a flag
         support_cache_dirty.insert( p );
     }
@@ -4311,6 +4361,7 @@ void map::i_clear(const tripoint &p)
 
     current_submap->lum[lx][ly] = 0;
     current_submap->itm[lx][ly].clear();
+    current_submap->is_dirty = true;
 }
 
 item &map::spawn_an_item(const tripoint &p, item new_item,
@@ -4492,7 +4543,11 @@ item &map::add_item_at( const tripoint &p,
     int lx, ly;
     submap * const current_submap = get_submap_at( p, lx, ly );
     current_submap->is_uniform = false;
+    current_submap->is_dirty = true;
 
+    if( !current_submap->lum[lx][ly] && new_item.is_emissive() ) {
+        set_light_source_dirty( p );
+    }
     current_submap->update_lum_add(new_item, lx, ly);
     const auto new_pos = current_submap->itm[lx][ly].insert( index, new_item );
     if( new_item.needs_processing() ) {
@@ -4699,9 +4754,12 @@ template<typename T>
 void map::process_items_in_vehicle( vehicle *const cur_veh, submap *const current_submap,
                                     T processor, std::string const &signal )
 {
-    std::vector<int> cargo_parts = cur_veh->all_parts_with_feature(VPFLAG_CARGO, true);
+    // Not a copy, the vehicle refills this list if parts get destroyed below.
+    const std::vector<int> &cargo_parts = cur_veh->parts_with_feature( VPFLAG_CARGO );
     for( int part : cargo_parts ) {
-        process_vehicle_items( cur_veh, part );
+        if( !cur_veh->parts[ part ].is_broken() ) {
+            process_vehicle_items( cur_veh, part );
+        }
     }
 
     for( auto &active_item : cur_veh->active_items.get() ) {
@@ -4712,7 +4770,8 @@ void map::process_items_in_vehicle( vehicle *const cur_veh, submap *const curren
         }
 
         auto const it = std::find_if(begin(cargo_parts), end(cargo_parts), [&](int const part) {
-            return active_item.location == cur_veh->parts[static_cast<size_t>(part)].mount;
+            return active_item.location == cur_veh->parts[static_cast<size_t>(part)].mount &&
+                   !cur_veh->parts[static_cast<size_t>(part)].is_broken();
         });
 
         if (it == std::end(cargo_parts)) {
@@ -4741,11 +4800,10 @@ void map::process_items_in_vehicle( vehicle *const cur_veh, submap *const curren
             return;
         }
 
-        // Vehicle still valid, reload the list of cargo parts,
-        // the list of cargo parts might have changed (imagine a part with
-        // a low index has been removed by an explosion, all the other
-        // parts would move up to fill the gap).
-        cargo_parts = cur_veh->all_parts_with_feature(VPFLAG_CARGO, false);
+        // Vehicle still valid, the list of cargo parts might have changed
+        // (imagine a part with a low index has been removed by an explosion,
+        // all the other parts would move up to fill the gap), but the
+        // vehicle has already refilled it.
     }
 }
 
@@ -5419,6 +5477,7 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     submap *const current_submap = get_submap_at( p, lx, ly );
     current_submap->is_uniform = false;
+    current_submap->is_dirty = true;
 
     if( current_submap->fld[lx][ly].addField( t, density, age ) ) {
         //Only adding it to the count if it doesn't exist.
@@ -5431,7 +5490,7 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     // Dirty the transparency cache now that field processing doesn't always do it
     // TODO: Make it skip transparent fields
-    set_transparency_cache_dirty( p.z );
+    set_transparency_cache_dirty( p );
 
     if( field_type_dangerous( t ) ) {
         set_pathfinding_cache_dirty( p.z );
@@ -5452,10 +5511,11 @@ void map::remove_field( const tripoint &p, const field_id field_to_remove )
     if( current_submap->fld[lx][ly].removeField( field_to_remove ) ) {
         // Only adjust the count if the field actually existed.
         current_submap->field_count--;
+        current_submap->is_dirty = true;
         const auto &fdata = fieldlist[ field_to_remove ];
         for( int i = 0; i < 3; ++i ) {
             if( !fdata.transparent[i] ) {
-                set_transparency_cache_dirty( p.z );
+                set_transparency_cache_dirty( p );
                 break;
             }
         }
@@ -5569,7 +5629,9 @@ void map::add_camp( const tripoint &p, const std::string& name )
         return;
     }
 
-    get_submap_at( p )->camp = basecamp( name, p.x, p.y );
+    submap *const current_submap = get_submap_at( p );
+    current_submap->camp = basecamp( name, p.x, p.y );
+    current_submap->is_dirty = true;
 }
 
 void map::debug()
@@ -6099,7 +6161,27 @@ void map::draw_from_above( WINDOW* w, player &u, const tripoint &p,
 bool map::sees( const tripoint &F, const tripoint &T, const int range ) const
 {
     int dummy = 0;
-    return sees( F, T, range, dummy );
+    if( ( range >= 0 && range < rl_dist( F, T ) ) || !inbounds( T ) ) {
+        return false;
+    }
+    // The 3D line checks the floors directly, they aren't cached
+    if( ( fov_3d && F.z != T.z ) || !inbounds( F ) ) {
+        return sees( F, T, range, dummy );
+    }
+
+    // The 2D line only depends on the transparency of the z-level of T
+    const uint64_t key = ( uint64_t( T.z + OVERMAP_DEPTH ) << 32 ) |
+                         ( uint64_t( F.x ) << 24 ) | ( uint64_t( F.y ) << 16 ) |
+                         ( uint64_t( T.x ) << 8 ) | uint64_t( T.y );
+    const auto iter = los_cache.find( key );
+    if( iter != los_cache.end() ) {
+        los_stats.hits++;
+        return iter->second;
+    }
+    los_stats.misses++;
+    const bool result = sees( F, T, -1, dummy );
+    los_cache.emplace( key, result );
+    return result;
 }
 
 /**
@@ -6380,6 +6462,7 @@ void map::shift( const int sx, const int sy )
     if( sx == 0 && sy == 0 ) {
         return; // Skip this?
     }
+    los_cache.clear();
     const int absx = get_abs_sub().x;
     const int absy = get_abs_sub().y;
     const int wz = get_abs_sub().z;
@@ -6637,6 +6720,10 @@ void map::loadn( const int gridx, const int gridy, const int gridz, const bool u
         }
     }
 
+    // Once on the map, the submap can be changed in many ways that don't go through
+    // the submap mutators, so it must be saved again.
+    tmpsub->is_dirty = true;
+
     // New submap changes the content of the map and all caches must be recalculated
     set_transparency_cache_dirty( gridz );
     set_outside_cache_dirty( gridz );
@@ -7385,90 +7472,117 @@ long map::determine_wall_corner( const tripoint &p ) const
 void map::build_outside_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    if( !ch.outside_cache_dirty ) {
+    auto &dirty_submaps = ch.outside_dirty_submaps;
+    if( ch.outside_cache_dirty ) {
+        dirty_submaps.set();
+    } else if( dirty_submaps.none() ) {
         return;
     }
 
-    // Make a bigger cache to avoid bounds checking
-    // We will later copy it to our regular cache
-    const size_t padded_w = ( MAPSIZE * SEEX ) + 2;
-    const size_t padded_h = ( MAPSIZE * SEEY ) + 2;
-    bool padded_cache[padded_w][padded_h];
+    for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
+        for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( dirty_submaps[smx + smy * MAPSIZE] ) {
+                build_outside_cache_submap( ch, smx, smy, zlev );
+                // The transparency depends on it (weather penalty).
+                ch.transparency_dirty_submaps.set( smx + smy * MAPSIZE );
+                // So do the sunlight openings at the edges of the neighbors.
+                if( smx > 0 ) {
+                    ch.light_source_dirty_submaps.set( smx - 1 + smy * MAPSIZE );
+                }
+                if( smx < my_MAPSIZE - 1 ) {
+                    ch.light_source_dirty_submaps.set( smx + 1 + smy * MAPSIZE );
+                }
+                if( smy > 0 ) {
+                    ch.light_source_dirty_submaps.set( smx + ( smy - 1 ) * MAPSIZE );
+                }
+                if( smy < my_MAPSIZE - 1 ) {
+                    ch.light_source_dirty_submaps.set( smx + ( smy + 1 ) * MAPSIZE );
+                }
+            }
+        }
+    }
+    dirty_submaps.reset();
+    ch.outside_cache_dirty = false;
+}
 
+void map::build_outside_cache_submap( level_cache &ch, const int smx, const int smy,
+                                      const int zlev )
+{
     auto &outside_cache = ch.outside_cache;
-    if( zlev < 0 )
-    {
-        std::uninitialized_fill_n(
-            &outside_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), false );
+    const int x0 = smx * SEEX;
+    const int y0 = smy * SEEY;
+    if( zlev < 0 ) {
+        for( int x = x0; x < x0 + SEEX; x++ ) {
+            std::fill_n( &outside_cache[x][y0], SEEY, false );
+        }
         return;
     }
 
-    std::uninitialized_fill_n(
-            &padded_cache[0][0], padded_w * padded_h, true );
-
-    for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
-        for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+    for( int x = x0; x < x0 + SEEX; x++ ) {
+        std::fill_n( &outside_cache[x][y0], SEEY, true );
+    }
 
-            for( int sx = 0; sx < SEEX; ++sx ) {
-                for( int sy = 0; sy < SEEY; ++sy ) {
-                    if( cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ||
-                        cur_submap->get_furn( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ) {
-                        const int x = sx + ( smx * SEEX );
-                        const int y = sy + ( smy * SEEY );
-                        // Add 1 to both coords, because we're operating on the padded cache
-                        for( int dx = 0; dx <= 2; dx++ )
-                        {
-                            for( int dy = 0; dy <= 2; dy++ )
-                            {
-                                padded_cache[x + dx][y + dy] = false;
-                            }
-                        }
-                    }
+    // An indoors tile makes itself and its neighbors not outside, so the tiles around
+    // the submap matter as well. Tiles beyond the edge of the map are outside.
+    const int xmin = std::max( x0 - 1, 0 );
+    const int ymin = std::max( y0 - 1, 0 );
+    const int xmax = std::min( x0 + SEEX, my_MAPSIZE * SEEX - 1 );
+    const int ymax = std::min( y0 + SEEY, my_MAPSIZE * SEEY - 1 );
+    for( int x = xmin; x <= xmax; x++ ) {
+        for( int y = ymin; y <= ymax; y++ ) {
+            int lx;
+            int ly;
+            submap *const cur_submap = get_submap_at( x, y, zlev, lx, ly );
+            if( !cur_submap->get_ter( lx, ly ).obj().has_flag( TFLAG_INDOORS ) &&
+                !cur_submap->get_furn( lx, ly ).obj().has_flag( TFLAG_INDOORS ) ) {
+                continue;
+            }
+            for( int dx = std::max( x - 1, x0 ); dx <= std::min( x + 1, x0 + SEEX - 1 ); dx++ ) {
+                for( int dy = std::max( y - 1, y0 ); dy <= std::min( y + 1, y0 + SEEY - 1 ); dy++ ) {
+                    outside_cache[dx][dy] = false;
                 }
             }
         }
     }
-
-    // Copy the padded cache back to the proper one, but with no padding
-    for( int x = 0; x < my_MAPSIZE * SEEX; x++ ) {
-        std::copy_n( &padded_cache[x + 1][1], my_MAPSIZE * SEEX, &outside_cache[x][0] );
-    }
-
-    ch.outside_cache_dirty = false;
 }
 
 void map::build_floor_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    if( !ch.floor_cache_dirty ) {
+    auto &dirty_submaps = ch.floor_dirty_submaps;
+    if( ch.floor_cache_dirty ) {
+        dirty_submaps.set();
+    } else if( dirty_submaps.none() ) {
         return;
     }
 
-    auto &floor_cache = ch.floor_cache;
-    std::uninitialized_fill_n(
-            &floor_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), true );
-
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
-
-            for( int sx = 0; sx < SEEX; ++sx ) {
-                for( int sy = 0; sy < SEEY; ++sy ) {
-                    // Note: furniture currently can't affect existence of floor
-                    if( cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_NO_FLOOR ) ) {
-                        const int x = sx + ( smx * SEEX );
-                        const int y = sy + ( smy * SEEY );
-                        floor_cache[x][y] = false;
-                    }
-                }
+            if( dirty_submaps[smx + smy * MAPSIZE] ) {
+                build_floor_cache_submap( ch, smx, smy, zlev );
             }
         }
     }
-
+    dirty_submaps.reset();
     ch.floor_cache_dirty = false;
 }
 
+void map::build_floor_cache_submap( level_cache &ch, const int smx, const int smy,
+                                    const int zlev )
+{
+    auto &floor_cache = ch.floor_cache;
+    auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+
+    for( int sx = 0; sx < SEEX; ++sx ) {
+        for( int sy = 0; sy < SEEY; ++sy ) {
+            // Note: furniture currently can't affect existence of floor
+            const int x = sx + ( smx * SEEX );
+            const int y = sy + ( smy * SEEY );
+            floor_cache[x][y] = !cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_NO_FLOOR );
+        }
+    }
+}
+
 void map::build_floor_caches()
 {
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
@@ -7504,8 +7618,14 @@ void map::build_map_cache( const int zlev, bool skip_lightmap )
                 continue;
             }
 
-            if( v.v->is_inside( part ) ) {
+            if( v.v->is_inside( part ) && outside_cache[px][py] ) {
                 outside_cache[px][py] = false;
+                // Sunlight no longer gets in here or through the neighbors.
+                for( int x = px - 1; x <= px + 1; x++ ) {
+                    for( int y = py - 1; y <= py + 1; y++ ) {
+                        set_light_source_dirty( tripoint( x, y, v.z ) );
+                    }
+                }
             }
 
             if( v.v->part_flag(part, VPFLAG_OPAQUE) && !v.v->parts[part].is_broken() ) {
@@ -7520,6 +7640,8 @@ void map::build_map_cache( const int zlev, bool skip_lightmap )
             }
         }
     }
+    // The transparency caches are final now
+    los_cache.clear();
 
     build_seen_cache( g->u.pos(), zlev );
     if( !skip_lightmap ) {
@@ -8059,8 +8181,11 @@ level_cache::level_cache()
 {
     transparency_cache_dirty = true;
     outside_cache_dirty = true;
+    floor_cache_dirty = true;
     veh_in_active_range = false;
     std::fill_n( &veh_exists_at[0][0], SEEX * MAPSIZE * SEEY * MAPSIZE, false );
+    std::fill_n( &light_source_buffer[0][0], SEEX * MAPSIZE * SEEY * MAPSIZE, 0.0f );
+    light_source_dirty_submaps.set();
 }
 
 pathfinding_cache::pathfinding_cache()
@@ -8082,6 +8207,41 @@ void map::set_pathfinding_cache_dirty( const int zlev ) {
     }
 }
 
+void map::set_transparency_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).transparency_dirty_submaps.set( p.x / SEEX + ( p.y / SEEY ) * MAPSIZE );
+    }
+}
+
+void map::set_outside_cache_dirty( const tripoint &p )
+{
+    if( !inbounds( p ) ) {
+        return;
+    }
+    // An indoors tile affects its neighbors too, which may be on other submaps.
+    auto &dirty_submaps = get_cache( p.z ).outside_dirty_submaps;
+    for( int x = std::max( p.x - 1, 0 ); x <= std::min( p.x + 1, my_MAPSIZE * SEEX - 1 ); x++ ) {
+        for( int y = std::max( p.y - 1, 0 ); y <= std::min( p.y + 1, my_MAPSIZE * SEEY - 1 ); y++ ) {
+            dirty_submaps.set( x / SEEX + ( y / SEEY ) * MAPSIZE );
+        }
+    }
+}
+
+void map::set_floor_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).floor_dirty_submaps.set( p.x / SEEX + ( p.y / SEEY ) * MAPSIZE );
+    }
+}
+
+void map::set_light_source_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).light_source_dirty_submaps.set( p.x / SEEX + ( p.y / SEEY ) * MAPSIZE );
+    }
+}
+
 const pathfinding_cache &map::get_pathfinding_cache_ref( int zlev ) const
 {
     if( !inbounds_z( zlev ) ) {
@@ -8104,6 +8264,7 @@ void map::update_pathfinding_cache( int zlev ) const
     }
 
     std::uninitialized_fill_n( &cache.special[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, PF_NORMAL );
+    cache.flow_fields.clear();
 
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
@@ -1,11 +1,15 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <bitset>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <set>
 #include <map>
 #include <memory>
+#include <queue>
+#include <unordered_map>
 
 #include "game_constants.h"
 #include "cursesdef.h"
@@ -134,15 +138,30 @@ struct level_cache {
     level_cache(); // Zeroes all relevant values
     level_cache( const level_cache &other ) = default;
 
+    // Whether the whole cache must be rebuilt.
     bool transparency_cache_dirty;
     bool outside_cache_dirty;
     bool floor_cache_dirty;
+    // Submaps (index x + y * MAPSIZE in grid coordinates) whose part of the cache must be
+    // rebuilt, in addition to the whole cache flags above.
+    std::bitset<MAPSIZE *MAPSIZE> transparency_dirty_submaps;
+    std::bitset<MAPSIZE *MAPSIZE> outside_dirty_submaps;
+    std::bitset<MAPSIZE *MAPSIZE> floor_dirty_submaps;
 
     float lm[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float sm[MAPSIZE*SEEX][MAPSIZE*SEEY];
     // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
     // This is only valid for the duration of generate_lightmap
     float light_source_buffer[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    // The tiles set in light_source_buffer, so only those are applied and cleared.
+    std::vector<point> light_source_points;
+    // Per submap: tiles whose items, terrain or fields may give off light, and indoors tiles
+    // next to outside ones with the direction (index into the four directions of
+    // generate_lightmap) the sunlight comes from. generate_lightmap looks up the actual light,
+    // the lists are rebuilt for the submaps marked in light_source_dirty_submaps.
+    std::vector<point> light_source_tiles[MAPSIZE * MAPSIZE];
+    std::vector<std::pair<point, int>> sunlight_openings[MAPSIZE * MAPSIZE];
+    std::bitset<MAPSIZE *MAPSIZE> light_source_dirty_submaps;
     bool outside_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     bool floor_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float transparency_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
@@ -151,7 +170,10 @@ struct level_cache {
 
     bool veh_in_active_range;
     bool veh_exists_at[SEEX * MAPSIZE][SEEY * MAPSIZE];
-    std::map< tripoint, std::pair<vehicle*,int> > veh_cached_parts;
+    // Where veh_exists_at is set: the index into cached_vehicles and the part on that tile.
+    std::pair<uint16_t, uint16_t> veh_cached_parts[SEEX * MAPSIZE][SEEY * MAPSIZE];
+    // Vehicles in the cache and the tiles they were cached on, empty slots have no vehicle.
+    std::vector<std::pair<vehicle *, std::vector<point>>> cached_vehicles;
     std::set<vehicle*> vehicle_list;
 };
 
@@ -221,6 +243,19 @@ class map
     }
 
     void set_pathfinding_cache_dirty( const int zlev );
+
+    /**
+     * Like the above, but only the parts of the caches that depend on the given tile
+     * are rebuilt. Use these when a single tile changed.
+     */
+    void set_transparency_cache_dirty( const tripoint &p );
+    void set_outside_cache_dirty( const tripoint &p );
+    void set_floor_cache_dirty( const tripoint &p );
+    /**
+     * Something on the tile may have started giving off light. Rebuilding the transparency
+     * cache of a submap implies this, so fields and whole z-levels need not call it.
+     */
+    void set_light_source_dirty( const tripoint &p );
     /*@}*/
 
 
@@ -374,8 +409,17 @@ public:
 // 3D Sees:
     /**
     * Returns whether `F` sees `T` with a view range of `range`.
+    * The results are remembered until the map cache is rebuilt, see @ref los_cache.
     */
     bool sees( const tripoint &F, const tripoint &T, int range ) const;
+    /** How many calls of @ref sees were answered from @ref los_cache and how many were not. */
+    struct los_cache_stats {
+        long hits = 0;
+        long misses = 0;
+    };
+    const los_cache_stats &get_los_cache_stats() const {
+        return los_stats;
+    }
  private:
     /**
      * Don't expose the slope adjust outside map functions.
@@ -439,6 +483,14 @@ public:
     std::vector<tripoint> route( const tripoint &f, const tripoint &t,
                                  const pathfinding_settings &settings,
                                  const std::set<tripoint> &pre_closed = {{ }} ) const;
+    /**
+     * Same as @ref route without pre-closed tiles, meant for creatures that chase the same
+     * target. Once several of them ask for the same target and settings within a turn, the
+     * distances to the target are calculated once into a @ref flow_field and their paths are
+     * read from it for the rest of the turn. Straight lines are taken as @ref route does.
+     */
+    std::vector<tripoint> shared_route( const tripoint &f, const tripoint &t,
+                                        const pathfinding_settings &settings ) const;
 
  int coord_to_angle(const int x, const int y, const int tgtx, const int tgty) const;
 // Vehicles: Common to 2D and 3D
@@ -456,6 +508,7 @@ public:
     // Vehicle movement
     void vehmove();
     // Selects a vehicle to move, returns false if no moving vehicles
+    // Only valid inside vehmove, which queues the moving vehicles
     bool vehproceed();
     // Actually moves a vehicle
     bool vehact( vehicle &veh );
@@ -1230,6 +1283,9 @@ protected:
                 const int zlevel, const regional_settings * rsettings);
 
  void build_transparency_cache( int zlev );
+    void build_transparency_cache_submap( level_cache &ch, int smx, int smy, int zlev );
+    void build_outside_cache_submap( level_cache &ch, int smx, int smy, int zlev );
+    void build_floor_cache_submap( level_cache &ch, int smx, int smy, int zlev );
 public:
  void build_outside_cache( int zlev );
     void build_floor_cache( int zlev );
@@ -1354,6 +1410,10 @@ private:
                       const tripoint &s, const tripoint &e, float luminance);
  void add_light_from_items( const tripoint &p, std::list<item>::iterator begin,
                             std::list<item>::iterator end );
+ // Lists the light sources and sunlight openings of a submap for generate_lightmap.
+ void build_light_sources_submap( level_cache &ch, int smx, int smy, int zlev );
+ // Adds the light given off by the items, terrain and fields of a tile.
+ void add_light_from_tile( const submap &sm, int sx, int sy, const tripoint &p );
  void calc_ray_end(int angle, int range, const tripoint &p, tripoint &out ) const;
  vehicle *add_vehicle_to_map( std::unique_ptr<vehicle> veh, bool merge_wrecks);
 
@@ -1422,6 +1482,34 @@ private:
 
     mutable std::array< std::unique_ptr<pathfinding_cache>, OVERMAP_LAYERS > pathfinding_caches;
 
+    /**
+     * Results of @ref sees by origin and target. Only valid as long as the transparency caches
+     * don't change, so it's cleared whenever the map cache is rebuilt or the map is shifted.
+     */
+    mutable std::unordered_map<uint64_t, bool> los_cache;
+    mutable los_cache_stats los_stats;
+
+    /** A vehicle waiting to move in @ref vehmove, with its of_turn when it was queued. */
+    struct queued_vehicle {
+        float of_turn;
+        /** Position in @ref get_vehicles at the start of the turn, breaks ties. */
+        size_t order;
+        vehicle *veh;
+
+        bool operator<( const queued_vehicle &other ) const {
+            // Most of_turn first, then the earliest in the list.
+            return of_turn < other.of_turn || ( of_turn == other.of_turn && order > other.order );
+        }
+    };
+    /**
+     * Vehicles with of_turn left during @ref vehmove. An entry is stale if the of_turn of the
+     * vehicle changed since, every change queues the vehicle again with the new value.
+     */
+    std::priority_queue<queued_vehicle> vehicle_queue;
+    /** Vehicles that may be in @ref vehicle_queue, with their position in the list. */
+    std::unordered_map<const vehicle *, size_t> vehicle_order;
+    void queue_vehicle( vehicle &veh );
+
     // Note: no bounds check
     level_cache &get_cache( int zlev ) {
         return *caches[zlev + OVERMAP_DEPTH];
@@ -1429,6 +1517,14 @@ private:
 
     pathfinding_cache &get_pathfinding_cache( int zlev ) const;
 
+    /**
+     * Cost of moving from cur onto the neighbouring tile p, without the penalty for diagonal
+     * moves, or one of the STEP_* values in pathfinding.cpp if that's not possible.
+     */
+    int step_cost( const tripoint &cur, const tripoint &p, const pathfinding_settings &settings,
+                   pf_special p_special ) const;
+    void build_flow_field( flow_field &field ) const;
+
     visibility_variables visibility_variables_cache;
 
   public:
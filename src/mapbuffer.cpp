@@ -14,13 +14,26 @@
 #include "trap.h"
 #include "vehicle.h"
 #include "submap.h"
+#include "background_writer.h"
+#include "quad_prefetcher.h"
+#include "options.h"
+#include "json.h"
 
+#include <cstdint>
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_MAP) << __FILE__ << ":" << __LINE__ << ": "
 
 mapbuffer MAPBUFFER;
 
+/**
+ * Turns prefetched data is kept without being requested again. A shift of the map
+ * while walking requests the bubble ahead about every dozen turns.
+ */
+static const int prefetch_max_age = 100;
+
 mapbuffer::mapbuffer()
 {
 }
@@ -36,6 +49,11 @@ void mapbuffer::reset()
         delete elem.second;
     }
     submaps.clear();
+    quad_lru.clear();
+    quad_lru_entries.clear();
+    vehicle_upkeep_submaps.clear();
+    // Also stops the worker thread, before the background writer it uses is gone at exit.
+    prefetcher.reset();
 }
 
 bool mapbuffer::add_submap(const tripoint &p, submap *sm)
@@ -45,6 +63,8 @@ bool mapbuffer::add_submap(const tripoint &p, submap *sm)
     }
 
     submaps[p] = sm;
+    touch_quad( p );
+    check_vehicle_upkeep( p, *sm );
 
     return true;
 }
@@ -75,6 +95,35 @@ void mapbuffer::remove_submap( tripoint addr )
     }
     delete m_target->second;
     submaps.erase( m_target );
+    vehicle_upkeep_submaps.erase( addr );
+
+    // Forget the quad once its last submap is gone.
+    const tripoint om_addr = sm_to_omt_copy( addr );
+    const tripoint first = omt_to_sm_copy( om_addr );
+    for( int x = 0; x < 2; x++ ) {
+        for( int y = 0; y < 2; y++ ) {
+            if( submaps.count( first + point( x, y ) ) != 0 ) {
+                return;
+            }
+        }
+    }
+    const auto entry = quad_lru_entries.find( om_addr );
+    if( entry != quad_lru_entries.end() ) {
+        quad_lru.erase( entry->second );
+        quad_lru_entries.erase( entry );
+    }
+}
+
+void mapbuffer::touch_quad( const tripoint &p )
+{
+    const tripoint om_addr = sm_to_omt_copy( p );
+    const auto entry = quad_lru_entries.find( om_addr );
+    if( entry != quad_lru_entries.end() ) {
+        quad_lru.splice( quad_lru.begin(), quad_lru, entry->second );
+    } else {
+        quad_lru.push_front( om_addr );
+        quad_lru_entries.emplace( om_addr, quad_lru.begin() );
+    }
 }
 
 submap *mapbuffer::lookup_submap(int x, int y, int z)
@@ -96,6 +145,7 @@ submap *mapbuffer::lookup_submap( const tripoint &p )
         return NULL;
     }
 
+    touch_quad( p );
     return iter->second;
 }
 
@@ -108,8 +158,7 @@ void mapbuffer::save( bool delete_after_save )
     int num_saved_submaps = 0;
     int num_total_submaps = submaps.size();
 
-    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
-    const bool map_has_zlevels = g != nullptr && g->m.has_zlevels();
+    last_save_stats = save_statistics();
 
     // A set of already-saved submaps, in global overmap coordinates.
     std::set<tripoint> saved_submaps;
@@ -138,28 +187,159 @@ void mapbuffer::save( bool delete_after_save )
         dirname << map_directory.str() << "/" << segment_addr.x << "." <<
                      segment_addr.y << "." << segment_addr.z;
 
+        // The extension depends on the format, see save_quad.
         std::stringstream quad_path;
         quad_path << dirname.str() << "/" << om_addr.x << "." <<
-                  om_addr.y << "." << om_addr.z << ".map";
+                  om_addr.y << "." << om_addr.z;
 
         // delete_on_save deletes everything, otherwise delete submaps
         // outside the current map.
-        const bool zlev_del = !map_has_zlevels && om_addr.z != g->get_levz();
+        const bool in_reality_bubble = mapbuffer::in_reality_bubble( om_addr );
         save_quad( dirname.str(), quad_path.str(), om_addr, submaps_to_delete,
-                   delete_after_save || zlev_del ||
-                   om_addr.x < map_origin.x || om_addr.y < map_origin.y ||
-                   om_addr.x > map_origin.x + (MAPSIZE / 2) ||
-                   om_addr.y > map_origin.y + (MAPSIZE / 2) );
+                   delete_after_save || !in_reality_bubble, in_reality_bubble );
         num_saved_submaps += 4;
     }
     for( auto &elem : submaps_to_delete ) {
         remove_submap( elem );
     }
+
+    DebugLog( D_INFO, D_MAP ) << "mapbuffer::save: " << last_save_stats.quads_written <<
+                              " quads written, " << last_save_stats.quads_skipped << " unchanged quads skipped, " <<
+                              last_save_stats.quads_uniform << " uniform quads skipped";
+}
+
+bool mapbuffer::in_reality_bubble( const tripoint &om_addr ) const
+{
+    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
+    const bool map_has_zlevels = g != nullptr && g->m.has_zlevels();
+    const bool zlev_del = !map_has_zlevels && om_addr.z != g->get_levz();
+    return !zlev_del &&
+           om_addr.x >= map_origin.x && om_addr.y >= map_origin.y &&
+           om_addr.x <= map_origin.x + (MAPSIZE / 2) &&
+           om_addr.y <= map_origin.y + (MAPSIZE / 2);
+}
+
+size_t mapbuffer::submap_budget()
+{
+    const int megabytes = get_option<int>( "MAPBUFFER_MEMORY" );
+    if( megabytes <= 0 ) {
+        return std::numeric_limits<size_t>::max();
+    }
+    // Only an estimate, items, fields and vehicles take additional memory.
+    return static_cast<size_t>( megabytes ) * 1024 * 1024 / sizeof( submap );
+}
+
+int mapbuffer::evict_unused( const size_t max_submaps )
+{
+    if( submaps.size() <= max_submaps ) {
+        return 0;
+    }
+    // Evict a bit more than necessary, so this doesn't happen again on the next turn.
+    const size_t target = max_submaps - max_submaps / 10;
+    const size_t old_size = submaps.size();
+
+    // The files are written in the background, the data is already serialized.
+    background_writer::deferred_scope deferred;
+    // Those are about the last call of save.
+    const save_statistics save_stats = last_save_stats;
+    std::list<tripoint> submaps_to_delete;
+    for( auto iter = quad_lru.rbegin(); iter != quad_lru.rend() &&
+         submaps.size() - submaps_to_delete.size() > target; ++iter ) {
+        const tripoint &om_addr = *iter;
+        if( in_reality_bubble( om_addr ) ) {
+            // Everything before was used more recently, but the bubble isn't big enough
+            // to fill the budget anyway.
+            continue;
+        }
+        bool needs_upkeep = false;
+        const tripoint first = omt_to_sm_copy( om_addr );
+        for( int x = 0; x < 2; x++ ) {
+            for( int y = 0; y < 2; y++ ) {
+                needs_upkeep = needs_upkeep || vehicle_upkeep_submaps.count( first + point( x, y ) ) != 0;
+            }
+        }
+        if( needs_upkeep ) {
+            continue;
+        }
+        const std::string path = quad_path( first );
+        try {
+            save_quad( path.substr( 0, path.find_last_of( '/' ) ), path, om_addr, submaps_to_delete,
+                       true, false );
+        } catch( const std::exception &err ) {
+            // Keep it, losing the changes would be worse.
+            debugmsg( "Failed to save submaps of %d,%d,%d: %s", om_addr.x, om_addr.y, om_addr.z,
+                      err.what() );
+        }
+    }
+    // Removing also removes the quads from the LRU list, which must not happen above.
+    for( auto &elem : submaps_to_delete ) {
+        remove_submap( elem );
+    }
+    last_save_stats = save_stats;
+
+    dbg( D_INFO ) << "mapbuffer::evict_unused: " << old_size - submaps.size() << " of " << old_size <<
+                  " submaps evicted";
+    return old_size - submaps.size();
+}
+
+void mapbuffer::check_vehicle_upkeep( const tripoint &p, const submap &sm )
+{
+    for( const vehicle *veh : sm.vehicles ) {
+        if( veh->needs_upkeep() ) {
+            vehicle_upkeep_submaps.insert( p );
+            return;
+        }
+    }
+}
+
+void mapbuffer::register_vehicle_upkeep( const tripoint &p )
+{
+    vehicle_upkeep_submaps.insert( p );
+}
+
+int mapbuffer::process_vehicles_outside_bubble()
+{
+    const tripoint abs_sub = g->m.get_abs_sub();
+    const bool zlevels = g->m.has_zlevels();
+    int processed = 0;
+    for( auto iter = vehicle_upkeep_submaps.begin(); iter != vehicle_upkeep_submaps.end(); ) {
+        const tripoint &p = *iter;
+        // Vehicles in the reality bubble are handled by the map.
+        if( ( zlevels || p.z == abs_sub.z ) &&
+            p.x >= abs_sub.x && p.x < abs_sub.x + MAPSIZE &&
+            p.y >= abs_sub.y && p.y < abs_sub.y + MAPSIZE ) {
+            ++iter;
+            continue;
+        }
+        const auto sm = submaps.find( p );
+        if( sm == submaps.end() ) {
+            iter = vehicle_upkeep_submaps.erase( iter );
+            continue;
+        }
+        bool still_needed = false;
+        for( vehicle *veh : sm->second->vehicles ) {
+            if( !veh->needs_upkeep() ) {
+                continue;
+            }
+            veh->power_parts();
+            veh->idle( false );
+            processed++;
+            // Running out of power or fuel changes the vehicle.
+            sm->second->is_dirty = true;
+            still_needed = still_needed || veh->needs_upkeep();
+        }
+        if( still_needed ) {
+            ++iter;
+        } else {
+            iter = vehicle_upkeep_submaps.erase( iter );
+        }
+    }
+    return processed;
 }
 
 void mapbuffer::save_quad( const std::string &dirname, const std::string &filename,
                            const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                           bool delete_after_save )
+                           bool delete_after_save, bool in_reality_bubble )
 {
     std::vector<point> offsets;
     std::vector<tripoint> submap_addrs;
@@ -169,19 +349,35 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
     offsets.push_back( point(1, 1) );
 
     bool all_uniform = true;
+    bool any_dirty = false;
     for( auto &offsets_offset : offsets ) {
         tripoint submap_addr = omt_to_sm_copy( om_addr );
         submap_addr.x += offsets_offset.x;
         submap_addr.y += offsets_offset.y;
         submap_addrs.push_back( submap_addr );
-        submap *sm = submaps[submap_addr];
+        const auto iter = submaps.find( submap_addr );
+        const submap *sm = iter != submaps.end() ? iter->second : nullptr;
         if( sm != nullptr && !sm->is_uniform ) {
             all_uniform = false;
         }
+        if( sm != nullptr && sm->is_dirty ) {
+            any_dirty = true;
+        }
     }
 
-    if( all_uniform ) {
-        // Nothing to save - this quad will be regenerated faster than it would be re-read
+    // Submaps inside the reality bubble can be changed by anything that runs on the map
+    // (item processing, vehicles, fields...), so they are always written. Everything else
+    // is only written if something changed it since it was loaded or last saved,
+    // otherwise the file on disk is still up to date.
+    const bool unchanged = !in_reality_bubble && !any_dirty;
+    if( all_uniform || unchanged ) {
+        // Nothing to save - this quad will be regenerated faster than it would be re-read,
+        // or it would be re-read as is.
+        if( all_uniform ) {
+            last_save_stats.quads_uniform++;
+        } else {
+            last_save_stats.quads_skipped++;
+        }
         if( delete_after_save ) {
             for( auto &submap_addr : submap_addrs ) {
                 if( submaps.count( submap_addr ) > 0 && submaps[submap_addr] != nullptr ) {
@@ -192,10 +388,53 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
 
         return;
     }
+    last_save_stats.quads_written++;
+
+    // Don't create the directory if it would be empty.
+    // A deferred write creates it on the writer thread.
+    if( !background_writer::is_deferring() ) {
+        assure_dir_exist( dirname.c_str() );
+    }
+    const bool binary = get_option<bool>( "BINARY_MAPS" );
+    const bool written = write_to_file_deferred( filename + quad_extension( binary ),
+    [&]( std::ostream & fout ) {
+        write_quad( fout, submap_addrs, binary );
+    }, nullptr );
+    if( !written ) {
+        throw std::runtime_error( string_format( _( "writing \"%s\" failed" ),
+                                  ( filename + quad_extension( binary ) ).c_str() ) );
+    }
+    // Anything read before is outdated now.
+    if( prefetcher ) {
+        prefetcher->forget( filename );
+    }
+    // The quad may still exist in the other format, which is outdated now.
+    remove_file_deferred( filename + quad_extension( !binary ) );
 
-    // Don't create the directory if it would be empty
-    assure_dir_exist( dirname.c_str() );
-    ofstream_wrapper_exclusive fout( filename );
+    // Submaps still in the reality bubble stay dirty, see above.
+    for( auto &submap_addr : submap_addrs ) {
+        const auto iter = submaps.find( submap_addr );
+        if( iter != submaps.end() && iter->second != nullptr ) {
+            iter->second->is_dirty = in_reality_bubble;
+            if( delete_after_save ) {
+                submaps_to_delete.push_back( submap_addr );
+            }
+        }
+    }
+}
+
+void mapbuffer::write_quad( std::ostream &fout, const std::vector<tripoint> &submap_addrs,
+                            const bool binary )
+{
+    if( binary ) {
+        write_quad_binary( fout, submap_addrs );
+    } else {
+        write_quad_json( fout, submap_addrs );
+    }
+}
+
+void mapbuffer::write_quad_json( std::ostream &fout, const std::vector<tripoint> &submap_addrs )
+{
     JsonOut jsout( fout );
     jsout.start_array();
     for( auto &submap_addr : submap_addrs ) {
@@ -377,19 +616,76 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
             jsout.member( "camp" );
             jsout.write( sm->camp.save_data() );
         }
-        if( delete_after_save ) {
-            submaps_to_delete.push_back( submap_addr );
-        }
         jsout.end_object();
     }
 
     jsout.end_array();
-    fout.close();
 }
 
-// We're reading in way too many entities here to mess around with creating sub-objects and
-// seeking around in them, so we're using the json streaming API.
-submap *mapbuffer::unserialize_submaps( const tripoint &p )
+// Reads a JSON array of items and places them on the submap, updating its caches.
+static void read_items( JsonIn &jsin, submap &sm, const int i, const int j )
+{
+    jsin.start_array();
+    while( !jsin.end_array() ) {
+        item tmp;
+        jsin.read( tmp );
+
+        if( tmp.is_emissive() ) {
+            sm.update_lum_add(tmp, i, j);
+        }
+
+        tmp.visit_items( [ &sm, i, j ]( item *it ) {
+            for( auto& e: it->magazine_convert() ) {
+                sm.itm[i][j].push_back( e );
+            }
+            return VisitResponse::NEXT;
+        } );
+
+        sm.itm[i][j].push_back( tmp );
+        if( tmp.needs_processing() ) {
+            sm.active_items.add( std::prev(sm.itm[i][j].end()), point( i, j ) );
+        }
+    }
+}
+
+std::string mapbuffer::quad_extension( const bool binary )
+{
+    return binary ? ".mapb" : ".map";
+}
+
+void mapbuffer::read_quad( std::istream &fin, const bool binary )
+{
+    if( binary ) {
+        deserialize_binary( fin );
+    } else {
+        JsonIn jsin( fin );
+        deserialize( jsin );
+    }
+}
+
+bool mapbuffer::convert_quad( const std::string &from, const std::string &to )
+{
+    const auto is_binary = []( const std::string &path ) {
+        const std::string ext = quad_extension( true );
+        return path.size() >= ext.size() && path.compare( path.size() - ext.size(), ext.size(), ext ) == 0;
+    };
+    mapbuffer tmp;
+    std::vector<tripoint> addrs;
+    const bool loaded = read_from_file( from, [&]( std::istream & fin ) {
+        tmp.read_quad( fin, is_binary( from ) );
+    } );
+    if( !loaded ) {
+        return false;
+    }
+    for( const auto &elem : tmp.submaps ) {
+        addrs.push_back( elem.first );
+    }
+    return write_to_file( to, [&]( std::ostream & fout ) {
+        tmp.write_quad( fout, addrs, is_binary( to ) );
+    }, nullptr );
+}
+
+std::string mapbuffer::quad_path( const tripoint &p )
 {
     // Map the tripoint to the submap quad that stores it.
     const tripoint om_addr = sm_to_omt_copy( p );
@@ -397,21 +693,120 @@ submap *mapbuffer::unserialize_submaps( const tripoint &p )
     std::stringstream quad_path;
     quad_path << world_generator->active_world->world_path << "/maps/" <<
               segment_addr.x << "." << segment_addr.y << "." << segment_addr.z << "/" <<
-              om_addr.x << "." << om_addr.y << "." << om_addr.z << ".map";
+              om_addr.x << "." << om_addr.y << "." << om_addr.z;
+    return quad_path.str();
+}
+
+void mapbuffer::prefetch( const tripoint &p )
+{
+    if( submaps.count( p ) != 0 ) {
+        return;
+    }
+    if( !prefetcher ) {
+        prefetcher.reset( new quad_prefetcher() );
+    }
+    prefetcher->request( quad_path( p ), get_option<bool>( "BINARY_MAPS" ) );
+}
+
+int mapbuffer::integrate_prefetched( const int max_quads )
+{
+    if( !prefetcher ) {
+        return 0;
+    }
+    prefetcher->expire( prefetch_max_age );
+    int added = 0;
+    for( const std::string &path : prefetcher->found_quads() ) {
+        if( added >= max_quads ) {
+            break;
+        }
+        std::string contents;
+        bool binary = false;
+        if( prefetcher->take( path, contents, binary ) != quad_prefetcher::status::found ) {
+            continue;
+        }
+        try {
+            add_quad( contents, binary );
+        } catch( const std::exception &err ) {
+            // It's read again (and the error reported) when it's actually needed.
+            dbg( D_ERROR ) << "prefetched quad " << path << " is invalid: " << err.what();
+        }
+        added++;
+    }
+    return added;
+}
 
-    using namespace std::placeholders;
-    if( !read_from_file_optional( quad_path.str(), std::bind( &mapbuffer::deserialize, this, _1 ) ) ) {
+void mapbuffer::add_quad( const std::string &contents, const bool binary )
+{
+    mapbuffer tmp;
+    if( binary ) {
+        std::istringstream fin( contents );
+        tmp.read_quad( fin, binary );
+    } else {
+        JsonIn jsin( contents.data(), contents.size() );
+        tmp.deserialize( jsin );
+    }
+    for( auto &elem : tmp.submaps ) {
+        if( !add_submap( elem.first, elem.second ) ) {
+            delete elem.second;
+        }
+    }
+    tmp.submaps.clear();
+}
+
+submap *mapbuffer::unserialize_submaps( const tripoint &p )
+{
+    const std::string quad_path = mapbuffer::quad_path( p );
+    std::string path;
+    bool found = false;
+
+    if( prefetcher ) {
+        std::string contents;
+        bool binary = false;
+        switch( prefetcher->take( quad_path, contents, binary ) ) {
+            case quad_prefetcher::status::missing:
+                // If it doesn't exist, trigger generating it.
+                return NULL;
+            case quad_prefetcher::status::found:
+                path = quad_path + quad_extension( binary );
+                try {
+                    add_quad( contents, binary );
+                    found = true;
+                } catch( const std::exception &err ) {
+                    debugmsg( "Failed to read from \"%1$s\": %2$s", path.c_str(), err.what() );
+                    return NULL;
+                }
+                break;
+            case quad_prefetcher::status::unknown:
+                break;
+        }
+    }
+
+    // Normally only one of the formats exists. If saving was interrupted before the
+    // outdated one was removed, the one matching the current option is the newer one.
+    const bool prefer_binary = get_option<bool>( "BINARY_MAPS" );
+    for( const bool binary : { prefer_binary, !prefer_binary } ) {
+        if( found ) {
+            break;
+        }
+        path = quad_path + quad_extension( binary );
+        found = read_from_file_optional( path, [this, binary]( std::istream & fin ) {
+            read_quad( fin, binary );
+        } );
+    }
+    if( !found ) {
         // If it doesn't exist, trigger generating it.
         return NULL;
     }
     if( submaps.count( p ) == 0 ) {
-        debugmsg("file %s did not contain the expected submap %d,%d,%d", quad_path.str().c_str(), p.x, p.y,
+        debugmsg("file %s did not contain the expected submap %d,%d,%d", path.c_str(), p.x, p.y,
                  p.z);
         return NULL;
     }
     return submaps[ p ];
 }
 
+// We're reading in way too many entities here to mess around with creating sub-objects and
+// seeking around in them, so we're using the json streaming API.
 void mapbuffer::deserialize( JsonIn &jsin )
 {
     jsin.start_array();
@@ -508,27 +903,7 @@ void mapbuffer::deserialize( JsonIn &jsin )
                 while( !jsin.end_array() ) {
                     int i = jsin.get_int();
                     int j = jsin.get_int();
-                    jsin.start_array();
-                    while( !jsin.end_array() ) {
-                        item tmp;
-                        jsin.read( tmp );
-
-                        if( tmp.is_emissive() ) {
-                            sm->update_lum_add(tmp, i, j);
-                        }
-
-                        tmp.visit_items( [ &sm, i, j ]( item *it ) {
-                            for( auto& e: it->magazine_convert() ) {
-                                sm->itm[i][j].push_back( e );
-                            }
-                            return VisitResponse::NEXT;
-                        } );
-
-                        sm->itm[i][j].push_back( tmp );
-                        if( tmp.needs_processing() ) {
-                            sm->active_items.add( std::prev(sm->itm[i][j].end()), point( i, j ) );
-                        }
-                    }
+                    read_items( jsin, *sm, i, j );
                 }
             } else if( submap_member_name == "traps" ) {
                 jsin.start_array();
@@ -608,6 +983,451 @@ void mapbuffer::deserialize( JsonIn &jsin )
                 jsin.skip_value();
             }
         }
+        // Freshly loaded, it's identical to what is on disk.
+        sm->is_dirty = false;
+        if( !add_submap( submap_coordinates, sm ) ) {
+            debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
+                      submap_coordinates.z );
+        }
+    }
+}
+
+// Binary quad format
+//
+// All integers are stored as LEB128 varints, signed ones zigzag encoded first. Strings are
+// stored as their length followed by the raw bytes.
+//
+//   magic "CDMB", format version, savegame_version
+//   palette: number of strings, strings (ids of terrain, furniture and traps)
+//   number of submaps, each:
+//     coordinates (signed x, y, z), turn_last_touched (signed), temperature (signed)
+//     terrain, furniture, traps: runs of (length, palette index) over the SEEX*SEEY tiles
+//     radiation: runs of (length, signed value)
+//     items: number of tiles, each: i, j, JSON array of the items
+//     fields: number of tiles, each: i, j, number of fields, each: type, density, age (signed)
+//     cosmetics: number of tiles, each: i, j, number of entries, each: key, value
+//     spawns: number, each: type, count, x, y, faction, mission (signed), friendly, name
+//     vehicles: number, each: JSON object of the vehicle
+//     computer and camp data, empty strings if there are none
+//
+// Tiles are always visited in the same order as in the JSON format (row by row).
+
+namespace
+{
+
+const char binary_quad_magic[4] = { 'C', 'D', 'M', 'B' };
+constexpr unsigned binary_quad_version = 1;
+
+class binary_out
+{
+    public:
+        binary_out( std::ostream &out ) : out( out ) { }
+
+        void write( uint32_t value ) {
+            do {
+                uint8_t byte = value & 0x7F;
+                value >>= 7;
+                if( value != 0 ) {
+                    byte |= 0x80;
+                }
+                out.put( static_cast<char>( byte ) );
+            } while( value != 0 );
+        }
+        void write_signed( const int value ) {
+            write( ( static_cast<uint32_t>( value ) << 1 ) ^ static_cast<uint32_t>( value >> 31 ) );
+        }
+        void write( const std::string &value ) {
+            write( static_cast<uint32_t>( value.size() ) );
+            out.write( value.data(), value.size() );
+        }
+
+    private:
+        std::ostream &out;
+};
+
+class binary_in
+{
+    public:
+        binary_in( std::istream &in ) : in( in ) { }
+
+        uint32_t read() {
+            uint32_t value = 0;
+            for( int shift = 0; shift < 35; shift += 7 ) {
+                const int byte = in.get();
+                if( byte == std::char_traits<char>::eof() ) {
+                    throw std::runtime_error( "unexpected end of binary map data" );
+                }
+                value |= static_cast<uint32_t>( byte & 0x7F ) << shift;
+                if( ( byte & 0x80 ) == 0 ) {
+                    return value;
+                }
+            }
+            throw std::runtime_error( "malformed integer in binary map data" );
+        }
+        int read_signed() {
+            const uint32_t value = read();
+            return static_cast<int>( value >> 1 ) ^ -static_cast<int>( value & 1 );
+        }
+        std::string read_string() {
+            const uint32_t size = read();
+            std::string value( size, '\0' );
+            if( size > 0 && !in.read( &value[0], size ) ) {
+                throw std::runtime_error( "unexpected end of binary map data" );
+            }
+            return value;
+        }
+        /** Reads a tile coordinate, checking that it's inside a submap. */
+        int read_coordinate( const int limit ) {
+            const uint32_t value = read();
+            if( value >= static_cast<uint32_t>( limit ) ) {
+                throw std::runtime_error( "tile coordinate out of bounds in binary map data" );
+            }
+            return value;
+        }
+
+    private:
+        std::istream &in;
+};
+
+/** Assigns palette indices to string ids, in order of first use. */
+class id_palette
+{
+    public:
+        uint32_t index_of( const std::string &id ) {
+            const auto iter = indices.find( id );
+            if( iter != indices.end() ) {
+                return iter->second;
+            }
+            const uint32_t index = ids.size();
+            indices.emplace( id, index );
+            ids.push_back( id );
+            return index;
+        }
+
+        std::vector<std::string> ids;
+
+    private:
+        std::unordered_map<std::string, uint32_t> indices;
+};
+
+/** Writes the run length encoded values of all tiles, the values are given by get(i, j). */
+template<typename Getter>
+void write_runs( binary_out &bout, Getter get, const bool is_signed )
+{
+    std::vector<std::pair<uint32_t, int>> runs;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            const int value = get( i, j );
+            if( !runs.empty() && runs.back().second == value ) {
+                runs.back().first++;
+            } else {
+                runs.emplace_back( 1, value );
+            }
+        }
+    }
+    bout.write( static_cast<uint32_t>( runs.size() ) );
+    for( const auto &run : runs ) {
+        bout.write( run.first );
+        if( is_signed ) {
+            bout.write_signed( run.second );
+        } else {
+            bout.write( static_cast<uint32_t>( run.second ) );
+        }
+    }
+}
+
+/** Reads what @ref write_runs wrote and calls set(i, j, value) for each tile. */
+template<typename Setter>
+void read_runs( binary_in &bin, Setter set, const bool is_signed )
+{
+    const uint32_t num_runs = bin.read();
+    int tile = 0;
+    for( uint32_t r = 0; r < num_runs; r++ ) {
+        const uint32_t length = bin.read();
+        const int value = is_signed ? bin.read_signed() : static_cast<int>( bin.read() );
+        if( length > static_cast<uint32_t>( SEEX * SEEY - tile ) ) {
+            throw std::runtime_error( "run exceeds submap size in binary map data" );
+        }
+        for( uint32_t n = 0; n < length; n++, tile++ ) {
+            set( tile % SEEX, tile / SEEX, value );
+        }
+    }
+    if( tile != SEEX * SEEY ) {
+        throw std::runtime_error( "runs do not cover the submap in binary map data" );
+    }
+}
+
+std::string to_json_string( const std::function<void( JsonOut & )> &writer )
+{
+    std::ostringstream buffer;
+    JsonOut jsout( buffer );
+    writer( jsout );
+    return buffer.str();
+}
+
+} // namespace
+
+void mapbuffer::write_quad_binary( std::ostream &fout, const std::vector<tripoint> &submap_addrs )
+{
+    std::vector<std::pair<tripoint, const submap *>> quad;
+    for( auto &submap_addr : submap_addrs ) {
+        const auto iter = submaps.find( submap_addr );
+        if( iter != submaps.end() && iter->second != nullptr ) {
+            quad.emplace_back( submap_addr, iter->second );
+        }
+    }
+
+    // The palette must precede the submaps, so they go to a buffer first.
+    id_palette palette;
+    std::ostringstream submap_data;
+    binary_out sout( submap_data );
+    sout.write( static_cast<uint32_t>( quad.size() ) );
+    for( const auto &elem : quad ) {
+        const tripoint &addr = elem.first;
+        const submap &sm = *elem.second;
+
+        sout.write_signed( addr.x );
+        sout.write_signed( addr.y );
+        sout.write_signed( addr.z );
+        sout.write_signed( sm.turn_last_touched );
+        sout.write_signed( sm.temperature );
+
+        write_runs( sout, [&]( int i, int j ) {
+            return palette.index_of( sm.ter[i][j].obj().id.str() );
+        }, false );
+        write_runs( sout, [&]( int i, int j ) {
+            return palette.index_of( sm.frn[i][j].obj().id.str() );
+        }, false );
+        write_runs( sout, [&]( int i, int j ) {
+            return palette.index_of( sm.trp[i][j].id().str() );
+        }, false );
+        write_runs( sout, [&]( int i, int j ) {
+            return sm.get_radiation( i, j );
+        }, true );
+
+        std::vector<point> tiles;
+        for( int j = 0; j < SEEY; j++ ) {
+            for( int i = 0; i < SEEX; i++ ) {
+                if( !sm.itm[i][j].empty() ) {
+                    tiles.emplace_back( i, j );
+                }
+            }
+        }
+        sout.write( static_cast<uint32_t>( tiles.size() ) );
+        for( const point &t : tiles ) {
+            sout.write( static_cast<uint32_t>( t.x ) );
+            sout.write( static_cast<uint32_t>( t.y ) );
+            sout.write( to_json_string( [&]( JsonOut & jsout ) {
+                jsout.write( sm.itm[t.x][t.y] );
+            } ) );
+        }
+
+        tiles.clear();
+        for( int j = 0; j < SEEY; j++ ) {
+            for( int i = 0; i < SEEX; i++ ) {
+                if( sm.fld[i][j].fieldCount() > 0 ) {
+                    tiles.emplace_back( i, j );
+                }
+            }
+        }
+        sout.write( static_cast<uint32_t>( tiles.size() ) );
+        for( const point &t : tiles ) {
+            const field &fld = sm.fld[t.x][t.y];
+            sout.write( static_cast<uint32_t>( t.x ) );
+            sout.write( static_cast<uint32_t>( t.y ) );
+            sout.write( static_cast<uint32_t>( fld.fieldCount() ) );
+            for( auto &f : fld ) {
+                const field_entry &cur = f.second;
+                sout.write( static_cast<uint32_t>( cur.getFieldType() ) );
+                sout.write_signed( cur.getFieldDensity() );
+                sout.write_signed( cur.getFieldAge() );
+            }
+        }
+
+        tiles.clear();
+        for( int j = 0; j < SEEY; j++ ) {
+            for( int i = 0; i < SEEX; i++ ) {
+                if( !sm.cosmetics[i][j].empty() ) {
+                    tiles.emplace_back( i, j );
+                }
+            }
+        }
+        sout.write( static_cast<uint32_t>( tiles.size() ) );
+        for( const point &t : tiles ) {
+            const auto &cosmetics = sm.cosmetics[t.x][t.y];
+            sout.write( static_cast<uint32_t>( t.x ) );
+            sout.write( static_cast<uint32_t>( t.y ) );
+            sout.write( static_cast<uint32_t>( cosmetics.size() ) );
+            for( const auto &entry : cosmetics ) {
+                sout.write( entry.first );
+                sout.write( entry.second );
+            }
+        }
+
+        sout.write( static_cast<uint32_t>( sm.spawns.size() ) );
+        for( const spawn_point &sp : sm.spawns ) {
+            sout.write( sp.type.str() );
+            sout.write_signed( sp.count );
+            sout.write_signed( sp.posx );
+            sout.write_signed( sp.posy );
+            sout.write_signed( sp.faction_id );
+            sout.write_signed( sp.mission_id );
+            sout.write( static_cast<uint32_t>( sp.friendly ? 1 : 0 ) );
+            sout.write( sp.name );
+        }
+
+        sout.write( static_cast<uint32_t>( sm.vehicles.size() ) );
+        for( const vehicle *veh : sm.vehicles ) {
+            sout.write( to_json_string( [&]( JsonOut & jsout ) {
+                jsout.write( *veh );
+            } ) );
+        }
+
+        // computer::save_data isn't const
+        sout.write( sm.comp.name.empty() ? std::string() : const_cast<computer &>( sm.comp ).save_data() );
+        sout.write( sm.camp.is_valid() ? sm.camp.save_data() : std::string() );
+    }
+
+    fout.write( binary_quad_magic, sizeof( binary_quad_magic ) );
+    binary_out bout( fout );
+    bout.write( binary_quad_version );
+    bout.write( static_cast<uint32_t>( savegame_version ) );
+    bout.write( static_cast<uint32_t>( palette.ids.size() ) );
+    for( const std::string &id : palette.ids ) {
+        bout.write( id );
+    }
+    const std::string data = submap_data.str();
+    fout.write( data.data(), data.size() );
+}
+
+void mapbuffer::deserialize_binary( std::istream &fin )
+{
+    char magic[sizeof( binary_quad_magic )];
+    if( !fin.read( magic, sizeof( magic ) ) ||
+        !std::equal( std::begin( magic ), std::end( magic ), std::begin( binary_quad_magic ) ) ) {
+        throw std::runtime_error( "not a binary map file" );
+    }
+    binary_in bin( fin );
+    const uint32_t version = bin.read();
+    if( version != binary_quad_version ) {
+        throw std::runtime_error( string_format( "unsupported binary map version %u", version ) );
+    }
+    // The savegame version the file was written with. Nothing needs to be migrated yet, the
+    // binary format is newer than all savegame versions that need migration.
+    bin.read();
+
+    std::vector<std::string> palette( bin.read() );
+    for( auto &id : palette ) {
+        id = bin.read_string();
+    }
+    const auto palette_entry = [&palette]( const int index ) -> const std::string & {
+        if( index < 0 || static_cast<size_t>( index ) >= palette.size() ) {
+            throw std::runtime_error( "palette index out of bounds in binary map data" );
+        }
+        return palette[index];
+    };
+
+    const uint32_t num_submaps = bin.read();
+    for( uint32_t n = 0; n < num_submaps; n++ ) {
+        std::unique_ptr<submap> sm( new submap() );
+        tripoint submap_coordinates;
+        submap_coordinates.x = bin.read_signed();
+        submap_coordinates.y = bin.read_signed();
+        submap_coordinates.z = bin.read_signed();
+        sm->turn_last_touched = bin.read_signed();
+        sm->temperature = bin.read_signed();
+
+        // Each distinct id is only looked up once per submap.
+        std::unordered_map<int, ter_id> ters;
+        read_runs( bin, [&]( int i, int j, int value ) {
+            auto iter = ters.find( value );
+            if( iter == ters.end() ) {
+                iter = ters.emplace( value, ter_str_id( palette_entry( value ) ).id() ).first;
+            }
+            sm->ter[i][j] = iter->second;
+        }, false );
+        std::unordered_map<int, furn_id> furns;
+        read_runs( bin, [&]( int i, int j, int value ) {
+            auto iter = furns.find( value );
+            if( iter == furns.end() ) {
+                iter = furns.emplace( value, furn_str_id( palette_entry( value ) ).id() ).first;
+            }
+            sm->frn[i][j] = iter->second;
+        }, false );
+        std::unordered_map<int, trap_id> traps;
+        read_runs( bin, [&]( int i, int j, int value ) {
+            auto iter = traps.find( value );
+            if( iter == traps.end() ) {
+                iter = traps.emplace( value, trap_str_id( palette_entry( value ) ).id() ).first;
+            }
+            sm->trp[i][j] = iter->second;
+        }, false );
+        read_runs( bin, [&]( int i, int j, int value ) {
+            sm->rad[i][j] = value;
+        }, true );
+
+        for( uint32_t num_tiles = bin.read(); num_tiles > 0; num_tiles-- ) {
+            const int i = bin.read_coordinate( SEEX );
+            const int j = bin.read_coordinate( SEEY );
+            const std::string items = bin.read_string();
+            JsonIn jsin( items.data(), items.size() );
+            read_items( jsin, *sm, i, j );
+        }
+
+        for( uint32_t num_tiles = bin.read(); num_tiles > 0; num_tiles-- ) {
+            const int i = bin.read_coordinate( SEEX );
+            const int j = bin.read_coordinate( SEEY );
+            for( uint32_t num_fields = bin.read(); num_fields > 0; num_fields-- ) {
+                const field_id type = field_id( bin.read() );
+                const int density = bin.read_signed();
+                const int age = bin.read_signed();
+                if( sm->fld[i][j].findField( type ) == nullptr ) {
+                    sm->field_count++;
+                }
+                sm->fld[i][j].addField( type, density, age );
+            }
+        }
+
+        for( uint32_t num_tiles = bin.read(); num_tiles > 0; num_tiles-- ) {
+            const int i = bin.read_coordinate( SEEX );
+            const int j = bin.read_coordinate( SEEY );
+            for( uint32_t num_entries = bin.read(); num_entries > 0; num_entries-- ) {
+                const std::string key = bin.read_string();
+                sm->cosmetics[i][j][key] = bin.read_string();
+            }
+        }
+
+        for( uint32_t num_spawns = bin.read(); num_spawns > 0; num_spawns-- ) {
+            const mtype_id type( bin.read_string() );
+            const int count = bin.read_signed();
+            const int i = bin.read_signed();
+            const int j = bin.read_signed();
+            const int faction_id = bin.read_signed();
+            const int mission_id = bin.read_signed();
+            const bool friendly = bin.read() != 0;
+            const std::string name = bin.read_string();
+            sm->spawns.push_back( spawn_point( type, count, i, j, faction_id, mission_id, friendly, name ) );
+        }
+
+        for( uint32_t num_vehicles = bin.read(); num_vehicles > 0; num_vehicles-- ) {
+            const std::string data = bin.read_string();
+            JsonIn jsin( data.data(), data.size() );
+            vehicle *tmp = new vehicle();
+            sm->vehicles.push_back( tmp );
+            jsin.read( *tmp );
+        }
+
+        const std::string computer_data = bin.read_string();
+        if( !computer_data.empty() ) {
+            sm->comp.load_data( computer_data );
+        }
+        const std::string camp_data = bin.read_string();
+        if( !camp_data.empty() ) {
+            sm->camp.load_data( camp_data );
+        }
+
+        // Freshly loaded, it's identical to what is on disk.
+        sm->is_dirty = false;
         if( !add_submap( submap_coordinates, sm ) ) {
             debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
                       submap_coordinates.z );
@@ -3,12 +3,16 @@
 
 #include <map>
 #include <list>
+#include <set>
 #include <memory>
+#include <iosfwd>
 #include <string>
+#include <vector>
 #include "enums.h"
 struct point;
 struct tripoint;
 struct submap;
+class quad_prefetcher;
 
 /**
  * Store, buffer, save and load the entire world map.
@@ -16,6 +20,16 @@ struct submap;
 class mapbuffer
 {
     public:
+        /** Counts of quads (2x2 submaps, one file each) handled by the last call to @ref save. */
+        struct save_statistics {
+            /** Quads that were written to disk. */
+            int quads_written = 0;
+            /** Quads that were not written because nothing in them changed since they were loaded. */
+            int quads_skipped = 0;
+            /** Quads that were not written because they consist of uniform submaps only. */
+            int quads_uniform = 0;
+        };
+
         mapbuffer();
         ~mapbuffer();
 
@@ -27,6 +41,10 @@ class mapbuffer
          **/
         void save( bool delete_after_save = false );
 
+        const save_statistics &get_save_statistics() const {
+            return last_save_stats;
+        }
+
         /** Delete all buffered submaps. **/
         void reset();
 
@@ -57,6 +75,60 @@ class mapbuffer
         submap *lookup_submap( int x, int y, int z );
         submap *lookup_submap( const tripoint &p );
 
+        /**
+         * Start reading the quad containing the given submap on a worker thread, unless
+         * it's already in the buffer. A later @ref lookup_submap uses the data read by then.
+         */
+        void prefetch( const tripoint &p );
+        /**
+         * Deserialize up to max_quads quads that have been prefetched into this buffer,
+         * so it doesn't need to be done when they are looked up. Quads that haven't been
+         * requested again for a while are dropped, so call this once per turn.
+         * @return The number of quads added.
+         */
+        int integrate_prefetched( int max_quads );
+
+        /**
+         * Write back and remove the least recently used quads until at most max_submaps
+         * submaps are left. Quads in the reality bubble and quads with vehicles that need
+         * upkeep (see @ref vehicle::needs_upkeep) are never removed.
+         * @return The number of submaps removed.
+         */
+        int evict_unused( size_t max_submaps );
+        /**
+         * Remember that the submap contains vehicles that need upkeep (see
+         * @ref vehicle::needs_upkeep), so @ref process_vehicles_outside_bubble handles it.
+         */
+        void register_vehicle_upkeep( const tripoint &p );
+        /**
+         * Run the per turn power and fuel processing for the vehicles outside the reality bubble
+         * that need it. Submaps whose vehicles don't need upkeep anymore are forgotten,
+         * parked vehicles cost nothing.
+         * @return The number of vehicles processed.
+         */
+        int process_vehicles_outside_bubble();
+        /** Number of submaps that fit into the memory budget of the MAPBUFFER_MEMORY option. */
+        static size_t submap_budget();
+        size_t size() const {
+            return submaps.size();
+        }
+
+        /** File extension of a quad file in the binary (".mapb") or JSON (".map") format. */
+        static std::string quad_extension( bool binary );
+        /**
+         * Write the given submaps of this buffer as one quad file. Submaps that are not
+         * in the buffer are skipped.
+         * @param binary Whether to use the binary format, see the BINARY_MAPS option.
+         */
+        void write_quad( std::ostream &fout, const std::vector<tripoint> &submap_addrs, bool binary );
+        /** Load all submaps of a quad file into this buffer. Throws on malformed input. */
+        void read_quad( std::istream &fin, bool binary );
+        /**
+         * Convert a quad file between the JSON and the binary format, the formats are
+         * determined by the file extensions. Returns whether the new file has been written.
+         */
+        static bool convert_quad( const std::string &from, const std::string &to );
+
     private:
         typedef std::map<tripoint, submap *> submap_map_t;
 
@@ -73,11 +145,30 @@ class mapbuffer
         // if not handled carefully, this can erase in-use submaps and crash the game.
         void remove_submap( tripoint addr );
         submap *unserialize_submaps( const tripoint &p );
+        /** Path of the quad file containing the submap, without extension. */
+        static std::string quad_path( const tripoint &p );
+        /** Loads the quad from memory, submaps that are already in the buffer are kept. */
+        void add_quad( const std::string &contents, bool binary );
+        bool in_reality_bubble( const tripoint &om_addr ) const;
+        /** Registers the submap if any of its vehicles needs upkeep. */
+        void check_vehicle_upkeep( const tripoint &p, const submap &sm );
+        /** Mark the quad containing the submap as most recently used. */
+        void touch_quad( const tripoint &p );
         void deserialize( JsonIn &jsin );
+        void deserialize_binary( std::istream &fin );
+        void write_quad_json( std::ostream &fout, const std::vector<tripoint> &submap_addrs );
+        void write_quad_binary( std::ostream &fout, const std::vector<tripoint> &submap_addrs );
         void save_quad( const std::string &dirname, const std::string &filename,
                         const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                        bool delete_after_save );
+                        bool delete_after_save, bool in_reality_bubble );
         submap_map_t submaps;
+        save_statistics last_save_stats;
+        std::unique_ptr<quad_prefetcher> prefetcher;
+        /** Quads (in overmap terrain coordinates) that have submaps in the buffer, most recently used first. */
+        std::list<tripoint> quad_lru;
+        std::map<tripoint, std::list<tripoint>::iterator> quad_lru_entries;
+        /** Submaps with vehicles that need upkeep, may contain some that don't need it anymore. */
+        std::set<tripoint> vehicle_upkeep_submaps;
 };
 
 extern mapbuffer MAPBUFFER;
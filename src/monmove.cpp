@@ -19,11 +19,14 @@
 #include "mtype.h"
 #include "field.h"
 #include "scent_map.h"
+#include "turn_profiler.h"
+#include "creature_tracker.h"
 
 #include <stdlib.h>
 //Used for e^(x) functions
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
 
 #define MONSTER_FOLLOW_DIST 8
 
@@ -193,6 +196,7 @@ float monster::rate_target( Creature &c, float best, bool smart ) const
 
 void monster::plan( const mfactions &factions )
 {
+    turn_profiler::scoped_timer timer( turn_profiler::stage::monster_plan );
     // Bots are more intelligent than most living stuff
     bool smart_planning = has_flag( MF_PRIORITIZE_TARGETS );
     Creature *target = nullptr;
@@ -207,6 +211,10 @@ void monster::plan( const mfactions &factions )
     bool group_morale = has_flag( MF_GROUP_MORALE ) && morale < type->morale;
     bool swarms = has_flag( MF_SWARMS );
     auto mood = attitude();
+    // Monsters we can't possibly see rate INT_MAX as target, so only the nearby ones matter
+    const int max_sight_range = std::max( { 1, sight_range( DAYLIGHT_LEVEL ), sight_range( 0 ) } );
+    const std::vector<int> nearby_monsters = g->critter_tracker->find_in_radius( pos(),
+            max_sight_range );
 
     // If we can see the player, move toward them or flee.
     if( friendly == 0 && sees( g->u ) ) {
@@ -219,7 +227,7 @@ void monster::plan( const mfactions &factions )
         }
     } else if( friendly != 0 && !docile ) {
         // Target unfriendly monsters, only if we aren't interacting with the player.
-        for( int i = 0, numz = g->num_zombies(); i < numz; i++ ) {
+        for( const int i : nearby_monsters ) {
             monster &tmp = g->zombie( i );
             if( tmp.friendly == 0 ) {
                 float rating = rate_target( tmp, dist, smart_planning );
@@ -265,7 +273,10 @@ void monster::plan( const mfactions &factions )
                 continue;
             }
 
-            for( int i : fac.second ) { // mon indices
+            for( int i : nearby_monsters ) { // mon indices
+                if( fac.second.count( i ) == 0 ) {
+                    continue;
+                }
                 monster &mon = g->zombie( i );
                 float rating = rate_target( mon, dist, smart_planning );
                 if( rating < dist ) {
@@ -293,7 +304,10 @@ void monster::plan( const mfactions &factions )
     }
     swarms = swarms && target == nullptr; // Only swarm if we have no target
     if( group_morale || swarms ) {
-        for( const int i : myfaction_iter->second ) {
+        for( const int i : nearby_monsters ) {
+            if( myfaction_iter->second.count( i ) == 0 ) {
+                continue;
+            }
             monster &mon = g->zombie( i );
             float rating = rate_target( mon, dist, smart_planning );
             if( group_morale && rating <= 10 ) {
@@ -643,7 +657,10 @@ void monster::move()
         if( pf_settings.max_dist >= rl_dist( pos(), goal ) &&
             ( path.empty() || rl_dist( pos(), path.front() ) >= 2 || path.back() != goal ) ) {
             // We need a new path
-            path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            // Hordes usually chase the same target, so they share the work
+            const auto path_avoid = get_path_avoid();
+            path = path_avoid.empty() ? g->m.shared_route( pos(), goal, pf_settings ) :
+                   g->m.route( pos(), goal, pf_settings, path_avoid );
         }
 
         // Try to respect old paths, even if we can't pathfind at the moment
@@ -876,6 +876,21 @@ void options_manager::init()
         0, 127, 5
         );
 
+    add("MAPBUFFER_MEMORY", "general", _("Map memory budget"),
+        _("Approximate amount of memory in megabytes used to keep maps of areas you have visited.  If more is needed, the least recently visited areas are saved and unloaded.  0 means unlimited."),
+        0, 16384, 512
+        );
+
+    add("BINARY_MAPS", "general", _("Save maps in binary format"),
+        _("If true, map files are saved in a compact binary format, which is faster to save and load than the default JSON format.  Maps in either format can always be loaded."),
+        false
+        );
+
+    add("SOUNDS_MUFFLED_BY_WALLS", "general", _("Walls muffle sounds"),
+        _("If true, monsters hear sounds quieter through walls and other opaque obstacles."),
+        false
+        );
+
     mOptionsSort["general"]++;
 
     add("CIRCLEDIST", "general", _("Circular distances"),
@@ -30,6 +30,7 @@
 #include "ui.h"
 #include "mapbuffer.h"
 #include "map_iterator.h"
+#include "background_writer.h"
 
 #include <stdlib.h>
 #include <time.h>
@@ -4381,13 +4382,17 @@ void overmap::save() const
     std::string const plrfilename = overmapbuffer::player_filename(loc.x, loc.y);
     std::string const terfilename = overmapbuffer::terrain_filename(loc.x, loc.y);
 
-    ofstream_wrapper fout_player( plrfilename );
-    serialize_view( fout_player );
-    fout_player.close();
+    if( !write_to_file_deferred( plrfilename, [&]( std::ostream & fout ) {
+        serialize_view( fout );
+    }, nullptr ) ) {
+        throw std::runtime_error( string_format( _( "writing \"%s\" failed" ), plrfilename.c_str() ) );
+    }
 
-    ofstream_wrapper_exclusive fout_terrain( terfilename );
-    serialize( fout_terrain );
-    fout_terrain.close();
+    if( !write_to_file_deferred( terfilename, [&]( std::ostream & fout ) {
+        serialize( fout );
+    }, nullptr ) ) {
+        throw std::runtime_error( string_format( _( "writing \"%s\" failed" ), terfilename.c_str() ) );
+    }
 }
 
 
@@ -12,10 +12,13 @@
 #include "mapdata.h"
 #include "cata_utility.h"
 #include "pathfinding.h"
+#include "turn_profiler.h"
 
 #include <algorithm>
-#include <queue>
+#include <array>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "messages.h"
 
@@ -31,86 +34,188 @@ constexpr int flat_index( const int x, const int y )
     return ( x * MAPSIZE * SEEY ) + y;
 };
 
+constexpr int layer_size = SEEX * MAPSIZE * SEEY * MAPSIZE;
+
 // Flattened 2D array representing a single z-level worth of pathfinding data
 struct path_data_layer {
-    // State is accessed way more often than all other values here
-    std::array< astar_state, SEEX *MAPSIZE *SEEY *MAPSIZE > state;
-    std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > score;
-    std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > gscore;
-    std::array< tripoint, SEEX *MAPSIZE *SEEY *MAPSIZE > parent;
-
-    void init( const int minx, const int miny, const int maxx, const int maxy ) {
-        for( int x = minx; x <= maxx; x++ ) {
-            for( int y = miny; y <= maxy; y++ ) {
-                const int ind = flat_index( x, y );
-                state[ind] = ASL_NONE; // Mark as unvisited
+    // State is accessed way more often than all other values here.
+    // An entry is only valid if its generation is the one of the current search,
+    // otherwise the tile is unvisited. This makes resetting the layer free.
+    std::array< unsigned, layer_size > generation;
+    std::array< astar_state, layer_size > state;
+    std::array< int, layer_size > score;
+    std::array< int, layer_size > gscore;
+    // Packed, see pathfinder::pack
+    std::array< int, layer_size > parent;
+
+    path_data_layer() {
+        generation.fill( 0 );
+    }
+};
+
+/**
+ * A priority queue of packed points, ordered by score. A 4-ary heap is shallower
+ * than a binary one, and its children share a cache line.
+ */
+class point_heap
+{
+    public:
+        bool empty() const {
+            return heap.empty();
+        }
+
+        void clear() {
+            heap.clear();
+        }
+
+        void push( const int score, const int point ) {
+            heap.emplace_back( score, point );
+            size_t i = heap.size() - 1;
+            const std::pair<int, int> value = heap[i];
+            while( i > 0 ) {
+                const size_t parent = ( i - 1 ) / 4;
+                if( heap[parent].first <= value.first ) {
+                    break;
+                }
+                heap[i] = heap[parent];
+                i = parent;
             }
+            heap[i] = value;
         }
-    };
+
+        int pop() {
+            const int result = heap.front().second;
+            const std::pair<int, int> value = heap.back();
+            heap.pop_back();
+            const size_t size = heap.size();
+            if( size == 0 ) {
+                return result;
+            }
+            size_t i = 0;
+            while( true ) {
+                const size_t first_child = i * 4 + 1;
+                if( first_child >= size ) {
+                    break;
+                }
+                size_t best = first_child;
+                const size_t last_child = std::min( first_child + 4, size );
+                for( size_t c = first_child + 1; c < last_child; c++ ) {
+                    if( heap[c].first < heap[best].first ) {
+                        best = c;
+                    }
+                }
+                if( value.first <= heap[best].first ) {
+                    break;
+                }
+                heap[i] = heap[best];
+                i = best;
+            }
+            heap[i] = value;
+            return result;
+        }
+
+    private:
+        std::vector<std::pair<int, int>> heap;
 };
 
+/**
+ * Working memory of the A* search. It is reused by all searches, so the big arrays are
+ * neither allocated nor cleared per call, see @ref path_data_layer::generation.
+ */
 struct pathfinder {
-    int minx;
-    int miny;
-    int maxx;
-    int maxy;
-    pathfinder( int _minx, int _miny, int _maxx, int _maxy ) :
-        minx( _minx ), miny( _miny ), maxx( _maxx ), maxy( _maxy ) {
-    }
+    int minx = 0;
+    int miny = 0;
+    int maxx = 0;
+    int maxy = 0;
+    unsigned current_generation = 0;
 
-    std::priority_queue< std::pair<int, tripoint>, std::vector< std::pair<int, tripoint> >, pair_greater_cmp >
-    open;
+    point_heap open;
     std::array< std::unique_ptr< path_data_layer >, OVERMAP_LAYERS > path_data;
 
+    /** Start a new search within the given bounds. */
+    void reset( const int _minx, const int _miny, const int _maxx, const int _maxy ) {
+        minx = _minx;
+        miny = _miny;
+        maxx = _maxx;
+        maxy = _maxy;
+        open.clear();
+        current_generation++;
+        if( current_generation == 0 ) {
+            // Wrapped around, old entries could look current.
+            for( auto &layer : path_data ) {
+                if( layer != nullptr ) {
+                    layer->generation.fill( 0 );
+                }
+            }
+            current_generation = 1;
+        }
+    }
+
+    static int pack( const tripoint &p ) {
+        return ( p.z + OVERMAP_DEPTH ) * layer_size + flat_index( p.x, p.y );
+    }
+
+    static tripoint unpack( const int packed ) {
+        const int index = packed % layer_size;
+        return tripoint( index / ( MAPSIZE * SEEY ), index % ( MAPSIZE * SEEY ),
+                         packed / layer_size - OVERMAP_DEPTH );
+    }
+
     path_data_layer &get_layer( const int z ) {
         auto &ptr = path_data[z + OVERMAP_DEPTH];
-        if( ptr != nullptr ) {
-            return *ptr;
+        if( ptr == nullptr ) {
+            ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
         }
-
-        ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
-        ptr->init( minx, miny, maxx, maxy );
         return *ptr;
     }
 
+    astar_state get_state( const path_data_layer &layer, const int index ) const {
+        return layer.generation[index] == current_generation ? layer.state[index] : ASL_NONE;
+    }
+
+    void set_state( path_data_layer &layer, const int index, const astar_state state ) {
+        layer.generation[index] = current_generation;
+        layer.state[index] = state;
+    }
+
     bool empty() const {
         return open.empty();
     }
 
     tripoint get_next() {
-        auto pt = open.top();
-        open.pop();
-        return pt.second;
+        return unpack( open.pop() );
     }
 
     void add_point( const int gscore, const int score, const tripoint &from, const tripoint &to ) {
         auto &layer = get_layer( to.z );
         const int index = flat_index( to.x, to.y );
-        if( ( layer.state[index] == ASL_OPEN && gscore >= layer.gscore[index] ) ||
-            layer.state[index] == ASL_CLOSED ) {
+        const astar_state state = get_state( layer, index );
+        if( ( state == ASL_OPEN && gscore >= layer.gscore[index] ) || state == ASL_CLOSED ) {
             return;
         }
 
-        layer.state [index] = ASL_OPEN;
+        set_state( layer, index, ASL_OPEN );
         layer.gscore[index] = gscore;
-        layer.parent[index] = from;
+        layer.parent[index] = pack( from );
         layer.score [index] = score;
-        open.push( std::make_pair( score, to ) );
+        open.push( score, pack( to ) );
     }
 
     void close_point( const tripoint &p ) {
-        auto &layer = get_layer( p.z );
-        const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_CLOSED;
+        set_state( get_layer( p.z ), flat_index( p.x, p.y ), ASL_CLOSED );
     }
 
     void unclose_point( const tripoint &p ) {
-        auto &layer = get_layer( p.z );
-        const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_NONE;
+        set_state( get_layer( p.z ), flat_index( p.x, p.y ), ASL_NONE );
     }
 };
 
+static pathfinder &get_pathfinder()
+{
+    static pathfinder instance;
+    return instance;
+}
+
 // Returns a tile with `flag` in the overmap tile that `t` is on
 template<ter_bitflags flag>
 tripoint vertical_move_destination( const map &m, const tripoint &t )
@@ -172,10 +277,125 @@ bool is_disjoint( const Set1 &set1, const Set2 &set2 )
     return true;
 }
 
+// Special results of map::step_cost
+// Can't be entered from this side
+constexpr int STEP_BLOCKED = -1;
+// Can't be entered from any side
+constexpr int STEP_CLOSED = -2;
+// A trap over a ledge, the creature drops down to the z-level below instead
+constexpr int STEP_LEDGE = -3;
+
+int map::step_cost( const tripoint &cur, const tripoint &p, const pathfinding_settings &settings,
+                    const pf_special p_special ) const
+{
+    const int bash = settings.bash_strength;
+    const bool doors = settings.allow_open_doors;
+    const bool trapavoid = settings.avoid_traps;
+
+    constexpr auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
+    if( !( p_special & non_normal ) ) {
+        // Boring flat dirt - the most common case above the ground
+        return 2;
+    }
+
+    // @todo De-uglify, de-huge-n
+    int newg = 0;
+    int part = -1;
+    const maptile &tile = maptile_at_internal( p );
+    const auto &terrain = tile.get_ter_t();
+    const auto &furniture = tile.get_furn_t();
+    const vehicle *veh = veh_at_internal( p, part );
+
+    const int cost = move_cost_internal( furniture, terrain, veh, part );
+    // Don't calculate bash rating unless we intend to actually use it
+    const int rating = ( bash == 0 || cost != 0 ) ? -1 :
+                       bash_rating_internal( bash, furniture, terrain, false, veh, part );
+
+    if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr ) {
+        return STEP_CLOSED;
+    }
+
+    newg += cost;
+    if( cost == 0 ) {
+        // Handle all kinds of doors
+        // Only try to open INSIDE doors from the inside
+        if( doors && terrain.open &&
+            ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( cur ) ) ) {
+            // To open and then move onto the tile
+            newg += 4;
+        } else if( veh != nullptr ) {
+            part = veh->obstacle_at_part( part );
+            int dummy = -1;
+            if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
+                ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
+                  veh_at_internal( cur, dummy ) == veh ) ) {
+                // Handle car doors, but don't try to path through curtains
+                newg += 10; // One turn to open, 4 to move there
+            } else if( part >= 0 && bash > 0 ) {
+                // Car obstacle that isn't a door
+                // @todo Account for armor
+                int hp = veh->parts[part].hp();
+                if( hp / 20 > bash ) {
+                    // Threshold damage thing means we just can't bash this down
+                    return STEP_CLOSED;
+                } else if( hp / 10 > bash ) {
+                    // Threshold damage thing means we will fail to deal damage pretty often
+                    hp *= 2;
+                }
+
+                newg += 2 * hp / bash + 8 + 4;
+            } else if( part >= 0 ) {
+                if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
+                    // Won't be openable, don't try from other sides
+                    return STEP_CLOSED;
+                }
+
+                return STEP_BLOCKED;
+            }
+        } else if( rating > 1 ) {
+            // Expected number of turns to bash it down, 1 turn to move there
+            // and 5 turns of penalty not to trash everything just because we can
+            newg += ( 20 / rating ) + 2 + 10;
+        } else if( rating == 1 ) {
+            // Desperate measures, avoid whenever possible
+            newg += 500;
+        } else {
+            // Unbashable and unopenable from here
+            if( !doors || !terrain.open ) {
+                // Or anywhere else for that matter
+                return STEP_CLOSED;
+            }
+
+            return STEP_BLOCKED;
+        }
+    }
+
+    if( trapavoid && p_special & PF_TRAP ) {
+        const auto &ter_trp = terrain.trap.obj();
+        const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
+        if( !trp.is_benign() ) {
+            // For now make them detect all traps
+            if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
+                // Special case - ledge in z-levels
+                // Warning: really expensive, needs a cache
+                if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
+                    return STEP_LEDGE;
+                }
+            } else if( trapavoid ) {
+                // Otherwise it's walkable
+                newg += 500;
+            }
+        }
+    }
+
+    return newg;
+}
+
 std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                                   const pathfinding_settings &settings,
                                   const std::set<tripoint> &pre_closed ) const
 {
+    turn_profiler::scoped_timer timer( turn_profiler::stage::route );
     /* TODO: If the origin or destination is out of bound, figure out the closest
      * in-bounds point and go to that, then to the real origin/destination.
      */
@@ -207,9 +427,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     }
 
     int max_length = settings.max_length;
-    int bash = settings.bash_strength;
-    bool doors = settings.allow_open_doors;
-    bool trapavoid = settings.avoid_traps;
 
     const int pad = 16;  // Should be much bigger - low value makes pathfinders dumb!
     int minx = std::min( f.x, t.x ) - pad;
@@ -221,7 +438,8 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     clip_to_bounds( minx, miny, minz );
     clip_to_bounds( maxx, maxy, maxz );
 
-    pathfinder pf( minx, miny, maxx, maxy );
+    pathfinder &pf = get_pathfinder();
+    pf.reset( minx, miny, maxx, maxy );
     // Make NPCs not want to path through player
     // But don't make player pathing stop working
     for( const auto &p : pre_closed ) {
@@ -242,8 +460,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
         const int parent_index = flat_index( cur.x, cur.y );
         auto &layer = pf.get_layer( cur.z );
-        auto &cur_state = layer.state[parent_index];
-        if( cur_state == ASL_CLOSED ) {
+        if( pf.get_state( layer, parent_index ) == ASL_CLOSED ) {
             continue;
         }
 
@@ -257,7 +474,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             break;
         }
 
-        cur_state = ASL_CLOSED;
+        pf.set_state( layer, parent_index, ASL_CLOSED );
 
         const auto &pf_cache = get_pathfinding_cache_ref( cur.z );
         const auto cur_special = pf_cache.special[cur.x][cur.y];
@@ -276,127 +493,40 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                 continue;
             }
 
-            if( layer.state[index] == ASL_CLOSED ) {
+            const astar_state p_state = pf.get_state( layer, index );
+            if( p_state == ASL_CLOSED ) {
                 continue;
             }
 
             // Penalize for diagonals or the path will look "unnatural"
             int newg = layer.gscore[parent_index] + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
 
-            const auto p_special = pf_cache.special[p.x][p.y];
-
-            constexpr auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
-            // @todo De-uglify, de-huge-n
-            if( !( p_special & non_normal ) ) {
-                // Boring flat dirt - the most common case above the ground
-                newg += 2;
-            } else {
-                int part = -1;
-                const maptile &tile = maptile_at_internal( p );
-                const auto &terrain = tile.get_ter_t();
-                const auto &furniture = tile.get_furn_t();
-                const vehicle *veh = veh_at_internal( p, part );
-
-                const int cost = move_cost_internal( furniture, terrain, veh, part );
-                // Don't calculate bash rating unless we intend to actually use it
-                const int rating = ( bash == 0 || cost != 0 ) ? -1 :
-                                   bash_rating_internal( bash, furniture, terrain, false, veh, part );
-
-                if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr ) {
-                    layer.state[index] = ASL_CLOSED; // Close it so that next time we won't try to calc costs
-                    continue;
-                }
-
-                newg += cost;
-                if( cost == 0 ) {
-                    // Handle all kinds of doors
-                    // Only try to open INSIDE doors from the inside
-                    if( doors && terrain.open &&
-                        ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( cur ) ) ) {
-                        // To open and then move onto the tile
-                        newg += 4;
-                    } else if( veh != nullptr ) {
-                        part = veh->obstacle_at_part( part );
-                        int dummy = -1;
-                        if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
-                            ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
-                              veh_at_internal( cur, dummy ) == veh ) ) {
-                            // Handle car doors, but don't try to path through curtains
-                            newg += 10; // One turn to open, 4 to move there
-                        } else if( part >= 0 && bash > 0 ) {
-                            // Car obstacle that isn't a door
-                            // @todo Account for armor
-                            int hp = veh->parts[part].hp();
-                            if( hp / 20 > bash ) {
-                                // Threshold damage thing means we just can't bash this down
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            } else if( hp / 10 > bash ) {
-                                // Threshold damage thing means we will fail to deal damage pretty often
-                                hp *= 2;
-                            }
-
-                            newg += 2 * hp / bash + 8 + 4;
-                        } else if( part >= 0 ) {
-                            if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
-                                // Won't be openable, don't try from other sides
-                                layer.state[index] = ASL_CLOSED;
-                            }
-
-                            continue;
-                        }
-                    } else if( rating > 1 ) {
-                        // Expected number of turns to bash it down, 1 turn to move there
-                        // and 5 turns of penalty not to trash everything just because we can
-                        newg += ( 20 / rating ) + 2 + 10;
-                    } else if( rating == 1 ) {
-                        // Desperate measures, avoid whenever possible
-                        newg += 500;
-                    } else {
-                        // Unbashable and unopenable from here
-                        if( !doors || !terrain.open ) {
-                            // Or anywhere else for that matter
-                            layer.state[index] = ASL_CLOSED;
-                        }
-
-                        continue;
-                    }
+            const int cost = step_cost( cur, p, settings, pf_cache.special[p.x][p.y] );
+            if( cost == STEP_CLOSED ) {
+                // Close it so that next time we won't try to calc costs
+                pf.set_state( layer, index, ASL_CLOSED );
+                continue;
+            } else if( cost == STEP_BLOCKED ) {
+                continue;
+            } else if( cost == STEP_LEDGE ) {
+                const tripoint below( p.x, p.y, p.z - 1 );
+                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
+                    // Otherwise this would have been a huge fall
+                    // From cur, not p, because we won't be walking on air
+                    pf.add_point( layer.gscore[parent_index] + 10,
+                                  layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
+                                  cur, below );
                 }
 
-                if( trapavoid && p_special & PF_TRAP ) {
-                    const auto &ter_trp = terrain.trap.obj();
-                    const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
-                    if( !trp.is_benign() ) {
-                        // For now make them detect all traps
-                        if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
-                            // Special case - ledge in z-levels
-                            // Warning: really expensive, needs a cache
-                            if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
-                                tripoint below( p.x, p.y, p.z - 1 );
-                                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
-                                    // Otherwise this would have been a huge fall
-                                    auto &layer = pf.get_layer( p.z - 1 );
-                                    // From cur, not p, because we won't be walking on air
-                                    pf.add_point( layer.gscore[parent_index] + 10,
-                                                  layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
-                                                  cur, below );
-                                }
-
-                                // Close p, because we won't be walking on it
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            }
-                        } else if( trapavoid ) {
-                            // Otherwise it's walkable
-                            newg += 500;
-                        }
-                    }
-                }
+                // Close p, because we won't be walking on it
+                pf.set_state( layer, index, ASL_CLOSED );
+                continue;
             }
+            newg += cost;
 
             // If not visited, add as open
             // If visited, add it only if we can do so with better score
-            if( layer.state[index] == ASL_NONE || newg < layer.gscore[index] ) {
+            if( p_state == ASL_NONE || newg < layer.gscore[index] ) {
                 pf.add_point( newg, newg + 2 * rl_dist( p, t ), cur, p );
             }
         }
@@ -412,7 +542,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             tripoint dest( cur.x, cur.y, cur.z - 1 );
             dest = vertical_move_destination<TFLAG_GOES_UP>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
                 pf.add_point( layer.gscore[parent_index] + 2,
                               layer.score[parent_index] + 2 * rl_dist( dest, t ),
                               cur, dest );
@@ -422,7 +551,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             tripoint dest( cur.x, cur.y, cur.z + 1 );
             dest = vertical_move_destination<TFLAG_GOES_DOWN>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
                 pf.add_point( layer.gscore[parent_index] + 2,
                               layer.score[parent_index] + 2 * rl_dist( dest, t ),
                               cur, dest );
@@ -430,7 +558,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         }
         if( cur.z < maxz && parent_terrain.has_flag( TFLAG_RAMP ) &&
             valid_move( cur, tripoint( cur.x, cur.y, cur.z + 1 ), false, true ) ) {
-            auto &layer = pf.get_layer( cur.z + 1 );
             for( size_t it = 0; it < 8; it++ ) {
                 const tripoint above( cur.x + x_offset[it], cur.y + y_offset[it], cur.z + 1 );
                 pf.add_point( layer.gscore[parent_index] + 4,
@@ -447,7 +574,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         for( int fdist = max_length; fdist != 0; fdist-- ) {
             const int cur_index = flat_index( cur.x, cur.y );
             const auto &layer = pf.get_layer( cur.z );
-            const tripoint &par = layer.parent[cur_index];
+            const tripoint par = pathfinder::unpack( layer.parent[cur_index] );
             if( cur == f ) {
                 break;
             }
@@ -469,3 +596,117 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
     return ret;
 }
+
+void map::build_flow_field( flow_field &field ) const
+{
+    turn_profiler::scoped_timer timer( turn_profiler::stage::flow_field );
+    const tripoint &t = field.target;
+    const pathfinding_settings &settings = field.settings;
+    // Covers the search area of every route that map::route would search for
+    const int radius = settings.max_dist + 16;
+    field.minx = std::max( t.x - radius, 0 );
+    field.miny = std::max( t.y - radius, 0 );
+    field.maxx = std::min( t.x + radius + 1, SEEX * my_MAPSIZE );
+    field.maxy = std::min( t.y + radius + 1, SEEY * my_MAPSIZE );
+    const int height = field.maxy - field.miny;
+    const int size = ( field.maxx - field.minx ) * height;
+    field.distance.assign( size, -1 );
+    field.next.assign( size, -1 );
+
+    const auto &pf_cache = get_pathfinding_cache_ref( t.z );
+    const auto to_index = [&field, height]( const int x, const int y ) {
+        return ( x - field.minx ) * height + y - field.miny;
+    };
+
+    // Dijkstra, but backwards: from the target to every tile that could step onto it
+    constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
+    constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
+    point_heap open;
+    const int target_index = to_index( t.x, t.y );
+    field.distance[target_index] = 0;
+    open.push( 0, target_index );
+    while( !open.empty() ) {
+        const int cur_index = open.pop();
+        const tripoint cur( field.minx + cur_index / height, field.miny + cur_index % height, t.z );
+        const int cur_distance = field.distance[cur_index];
+        const pf_special cur_special = pf_cache.special[cur.x][cur.y];
+        for( size_t i = 0; i < 8; i++ ) {
+            const tripoint p( cur.x + x_offset[i], cur.y + y_offset[i], t.z );
+            if( p.x < field.minx || p.x >= field.maxx || p.y < field.miny || p.y >= field.maxy ) {
+                continue;
+            }
+
+            // Stepping from p onto cur, some doors can only be opened from one side
+            const int cost = step_cost( p, cur, settings, cur_special );
+            if( cost < 0 ) {
+                continue;
+            }
+
+            // Penalize for diagonals, same as map::route
+            const int new_distance = cur_distance + cost + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
+            const int index = to_index( p.x, p.y );
+            if( new_distance > settings.max_length ||
+                ( field.distance[index] != -1 && field.distance[index] <= new_distance ) ) {
+                continue;
+            }
+            field.distance[index] = new_distance;
+            field.next[index] = cur_index;
+            open.push( new_distance, index );
+        }
+    }
+}
+
+std::vector<tripoint> map::shared_route( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings ) const
+{
+    if( f == t || f.z != t.z || !inbounds( f ) || !inbounds( t ) ||
+        rl_dist( f, t ) > settings.max_dist ) {
+        return route( f, t, settings );
+    }
+    // Same shortcut as map::route, nothing to share when walking straight at the target
+    if( clear_path( f, t, -1, 2, 2 ) ) {
+        return line_to( f, t );
+    }
+
+    // Clears the fields if anything changed since they were built
+    get_pathfinding_cache_ref( t.z );
+    auto &fields = get_pathfinding_cache( t.z ).flow_fields;
+    const int turn = calendar::turn;
+    // Vehicles moving, doors opening and parts breaking don't dirty the pathfinding cache,
+    // so the fields are only used in the turn they were built in.
+    fields.erase( std::remove_if( fields.begin(), fields.end(), [turn]( const flow_field & ff ) {
+        return ff.last_used != turn;
+    } ), fields.end() );
+    auto iter = std::find_if( fields.begin(), fields.end(), [&t, &settings]( const flow_field & ff ) {
+        return ff.target == t && ff.settings == settings;
+    } );
+    if( iter == fields.end() ) {
+        fields.emplace_back();
+        iter = fields.end() - 1;
+        iter->target = t;
+        iter->settings = settings;
+        iter->last_used = turn;
+    }
+    flow_field &field = *iter;
+    field.requests++;
+
+    if( field.distance.empty() ) {
+        if( field.requests < 2 ) {
+            // Not worth it for a single creature
+            return route( f, t, settings );
+        }
+        build_flow_field( field );
+    }
+
+    std::vector<tripoint> ret;
+    const int height = field.maxy - field.miny;
+    int index = ( f.x - field.minx ) * height + f.y - field.miny;
+    if( field.distance[index] == -1 ) {
+        return ret;
+    }
+    while( field.next[index] != -1 ) {
+        index = field.next[index];
+        ret.emplace_back( field.minx + index / height, field.miny + index % height, t.z );
+    }
+    return ret;
+}
@@ -1,8 +1,11 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "enums.h"
 #include "game_constants.h"
 
+#include <vector>
+
 class JsonObject;
 
 enum pf_special : char {
@@ -37,15 +40,6 @@ inline pf_special &operator &= ( pf_special &lhs, pf_special rhs )
     return lhs;
 }
 
-struct pathfinding_cache {
-    pathfinding_cache();
-    ~pathfinding_cache();
-
-    bool dirty;
-
-    pf_special special[MAPSIZE * SEEX][MAPSIZE * SEEY];
-};
-
 struct pathfinding_settings {
     int bash_strength = 0;
     int max_dist = 0;
@@ -62,6 +56,47 @@ struct pathfinding_settings {
     pathfinding_settings( int bs, int md, int ml, bool aod, bool at, bool acs )
         : bash_strength( bs ), max_dist( md ), max_length( ml ), allow_open_doors( aod ),
           avoid_traps( at ), allow_climb_stairs( acs ) {}
+
+    bool operator==( const pathfinding_settings &rhs ) const {
+        return bash_strength == rhs.bash_strength && max_dist == rhs.max_dist &&
+               max_length == rhs.max_length && allow_open_doors == rhs.allow_open_doors &&
+               avoid_traps == rhs.avoid_traps && allow_climb_stairs == rhs.allow_climb_stairs;
+    }
+};
+
+/**
+ * Cost of the path to a target from every tile around it, on the target's z-level.
+ * Creatures that chase the same target with the same settings share one, see
+ * @ref map::shared_route.
+ */
+struct flow_field {
+    tripoint target;
+    pathfinding_settings settings;
+    /** Turn it was requested in, fields of earlier turns get dropped. */
+    int last_used = 0;
+    /** Requests in that turn. It's only built once it's shared. */
+    int requests = 0;
+    /** Bounds of the field in local map coordinates, the maximum is exclusive. */
+    int minx = 0;
+    int miny = 0;
+    int maxx = 0;
+    int maxy = 0;
+    /** Cost of the path from each tile to the target, -1 if there is none. Empty until built. */
+    std::vector<int> distance;
+    /** Index (into the above) of the next tile on the path to the target. */
+    std::vector<int> next;
+};
+
+struct pathfinding_cache {
+    pathfinding_cache();
+    ~pathfinding_cache();
+
+    bool dirty;
+
+    pf_special special[MAPSIZE * SEEX][MAPSIZE * SEEY];
+
+    /** Only valid as long as the cache isn't dirty, cleared when it's rebuilt. */
+    std::vector<flow_field> flow_fields;
 };
 
 #endif
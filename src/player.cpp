@@ -11816,18 +11816,25 @@ const recipe_subset player::get_recipes_from_books( const inventory &crafting_in
 {
     recipe_subset res;
 
-    for( const auto &stack : crafting_inv.const_slice() ) {
-        const item &candidate = stack->front();
-
-        if( !candidate.is_book() ) {
-            continue;
+    // The books on the map are only counted by the index of the crafting inventory.
+    std::set<itype_id> books;
+    if( const auto index = crafting_inv.get_index() ) {
+        books = index->books;
+    } else {
+        for( const auto &stack : crafting_inv.const_slice() ) {
+            if( stack->front().is_book() ) {
+                books.insert( stack->front().typeId() );
+            }
         }
+    }
+
+    for( const itype_id &book : books ) {
         // NPCs don't need to identify books
-        if( is_player() && !items_identified.count( candidate.typeId() ) ) {
+        if( is_player() && !items_identified.count( book ) ) {
             continue;
         }
 
-        for( auto const &elem : candidate.type->book->recipes ) {
+        for( auto const &elem : item::find_type( book )->book->recipes ) {
             if( get_skill_level( elem.recipe->skill_used ) >= elem.skill_level ) {
                 res.include( elem.recipe, elem.skill_level );
             }
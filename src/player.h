@@ -1190,8 +1190,10 @@ class player : public Character, public JsonSerializer, public JsonDeserializer
                                    bool from_ground, const recipe &dis );
 
         // yet more crafting.cpp
-        const inventory &crafting_inventory(); // includes nearby items
+        const inventory &crafting_inventory(); // includes nearby items, see inventory::form_index_from_map
         void invalidate_crafting_inventory();
+        /** Which recipes can be made with the current crafting inventory */
+        recipe_availability &crafting_availability();
         std::vector<item> get_eligible_containers_for_crafting();
         comp_selection<item_comp>
             select_item_component( const std::vector<item_comp> &components,
@@ -1512,6 +1514,7 @@ class player : public Character, public JsonSerializer, public JsonDeserializer
         tripoint next_expected_position;
 
         inventory cached_crafting_inventory;
+        recipe_availability cached_crafting_availability;
         int cached_moves;
         int cached_turn;
         tripoint cached_position;
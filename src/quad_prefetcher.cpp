@@ -0,0 +1,182 @@
+#include "quad_prefetcher.h"
+
+#include "background_writer.h"
+#include "mapbuffer.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+
+/** Quads that have been read but not taken yet, requests beyond that are dropped. */
+constexpr size_t max_found_entries = 128;
+
+bool read_file( const std::string &path, std::string &contents )
+{
+    // A pending autosave of the file must be on disk first.
+    background_writer::wait_for( path );
+    std::ifstream fin( path, std::ios::binary );
+    if( !fin.is_open() ) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << fin.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+} // namespace
+
+quad_prefetcher::~quad_prefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+        queue.clear();
+    }
+    wake_worker.notify_all();
+    if( worker.joinable() ) {
+        worker.join();
+    }
+}
+
+void quad_prefetcher::request( const std::string &quad_path, const bool prefer_binary )
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        const auto iter = entries.find( quad_path );
+        if( iter != entries.end() ) {
+            iter->second.last_request = age;
+            return;
+        }
+        if( found_entries >= max_found_entries ) {
+            return;
+        }
+        if( !worker.joinable() ) {
+            worker = std::thread( &quad_prefetcher::run, this );
+        }
+        entry &e = entries[quad_path];
+        e.prefer_binary = prefer_binary;
+        e.request_id = next_request_id++;
+        e.last_request = age;
+        queue.push_back( quad_path );
+    }
+    wake_worker.notify_one();
+}
+
+quad_prefetcher::status quad_prefetcher::take( const std::string &quad_path,
+        std::string &contents, bool &binary )
+{
+    std::unique_lock<std::mutex> lock( mutex );
+    // Reading it again on this thread would only take longer.
+    job_done.wait( lock, [this, &quad_path]() {
+        return current_path != quad_path;
+    } );
+    const auto iter = entries.find( quad_path );
+    if( iter == entries.end() ) {
+        return status::unknown;
+    }
+    const status result = iter->second.state;
+    if( result == status::unknown ) {
+        // Still queued, the caller is faster reading it itself. The worker skips it now.
+        erase( iter );
+        return result;
+    }
+    contents = std::move( iter->second.contents );
+    binary = iter->second.binary;
+    erase( iter );
+    return result;
+}
+
+void quad_prefetcher::forget( const std::string &quad_path )
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    // If it's being read right now, the worker notices the missing entry.
+    const auto iter = entries.find( quad_path );
+    if( iter != entries.end() ) {
+        erase( iter );
+    }
+}
+
+std::vector<std::string> quad_prefetcher::found_quads()
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    std::vector<std::string> result;
+    for( const auto &elem : entries ) {
+        if( elem.second.state == status::found ) {
+            result.push_back( elem.first );
+        }
+    }
+    return result;
+}
+
+void quad_prefetcher::expire( const int max_age )
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    age++;
+    for( auto iter = entries.begin(); iter != entries.end(); ) {
+        if( age - iter->second.last_request > max_age ) {
+            // Queued quads are skipped by the worker now.
+            iter = erase( iter );
+        } else {
+            ++iter;
+        }
+    }
+}
+
+std::map<std::string, quad_prefetcher::entry>::iterator quad_prefetcher::erase(
+    const std::map<std::string, entry>::iterator iter )
+{
+    if( iter->second.state == status::found ) {
+        found_entries--;
+    }
+    return entries.erase( iter );
+}
+
+void quad_prefetcher::run()
+{
+    std::unique_lock<std::mutex> lock( mutex );
+    while( true ) {
+        wake_worker.wait( lock, [this]() {
+            return stopping || !queue.empty();
+        } );
+        if( stopping ) {
+            return;
+        }
+        const std::string quad_path = queue.front();
+        queue.pop_front();
+        const auto iter = entries.find( quad_path );
+        if( iter == entries.end() || iter->second.state != status::unknown ) {
+            continue;
+        }
+        const bool prefer_binary = iter->second.prefer_binary;
+        const int request_id = iter->second.request_id;
+        current_path = quad_path;
+
+        lock.unlock();
+        // Same order as mapbuffer::unserialize_submaps.
+        entry result;
+        result.state = status::missing;
+        result.request_id = request_id;
+        for( const bool binary : { prefer_binary, !prefer_binary } ) {
+            if( read_file( quad_path + mapbuffer::quad_extension( binary ), result.contents ) ) {
+                result.state = status::found;
+                result.binary = binary;
+                break;
+            }
+        }
+        lock.lock();
+
+        const auto target = entries.find( quad_path );
+        if( target != entries.end() && target->second.request_id == request_id ) {
+            result.last_request = target->second.last_request;
+            target->second = std::move( result );
+            if( target->second.state == status::found ) {
+                found_entries++;
+            }
+        }
+        current_path.clear();
+        job_done.notify_all();
+    }
+}
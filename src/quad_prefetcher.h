@@ -0,0 +1,98 @@
+#ifndef QUAD_PREFETCHER_H
+#define QUAD_PREFETCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+/**
+ * Reads map quad files on a worker thread before the game needs them.
+ *
+ * Only the file I/O happens on the worker: deserializing submaps creates items and
+ * vehicles, which touches global game state and must stay on the main thread. The
+ * contents are kept in memory until the @ref mapbuffer takes them.
+ *
+ * Quads are identified by their path without the file extension, the worker tries
+ * both formats (see @ref mapbuffer::quad_extension).
+ */
+class quad_prefetcher
+{
+    public:
+        quad_prefetcher() = default;
+        ~quad_prefetcher();
+
+        quad_prefetcher( const quad_prefetcher & ) = delete;
+        quad_prefetcher &operator=( const quad_prefetcher & ) = delete;
+
+        enum class status {
+            /** Not requested (or forgotten since). */
+            unknown,
+            /** Neither format exists on disk, the quad has to be generated. */
+            missing,
+            /** The file has been read. */
+            found,
+        };
+
+        /**
+         * Queue the reading of the quad, unless it's already queued or read. Requests are
+         * dropped while too many quads that have been read are waiting to be taken.
+         * @param prefer_binary Which format to try first, see @ref mapbuffer::unserialize_submaps.
+         */
+        void request( const std::string &quad_path, bool prefer_binary );
+        /**
+         * Hand over the result for the quad and forget about it. Waits if the quad is being
+         * read right now. If the result is @ref status::found, contents and binary are set.
+         */
+        status take( const std::string &quad_path, std::string &contents, bool &binary );
+        /** Drop the result for the quad, e.g. because the file is going to be overwritten. */
+        void forget( const std::string &quad_path );
+        /** Paths of all quads that have been read and can be taken without waiting. */
+        std::vector<std::string> found_quads();
+        /**
+         * Drop the quads that haven't been requested again within the last max_age calls
+         * of this function. Call it once per turn, otherwise quads that were predicted
+         * but never visited would be kept forever.
+         */
+        void expire( int max_age );
+
+    private:
+        struct entry {
+            status state = status::unknown;
+            bool prefer_binary = false;
+            bool binary = false;
+            std::string contents;
+            /** Distinguishes a re-requested quad from a forgotten one that was being read. */
+            int request_id = 0;
+            /** Value of @ref age when the quad was requested the last time. */
+            int last_request = 0;
+        };
+
+        void run();
+        /** Remove the entry, keeping @ref found_entries up to date. Requires the lock. */
+        std::map<std::string, entry>::iterator erase( std::map<std::string, entry>::iterator iter );
+
+        std::mutex mutex;
+        std::condition_variable wake_worker;
+        std::condition_variable job_done;
+        std::thread worker;
+        bool stopping = false;
+        /** All requested quads, entries in state unknown are queued or being read. */
+        std::map<std::string, entry> entries;
+        std::deque<std::string> queue;
+        /** Path of the quad that is currently being read, empty if idle. */
+        std::string current_path;
+        int next_request_id = 0;
+        /** Number of calls to @ref expire so far. */
+        int age = 0;
+        /** Number of entries in state found, only those count towards the limit. */
+        size_t found_entries = 0;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "cata_utility.h"
 #include "crafting.h"
 #include "skill.h"
+#include "inventory.h"
 
 #include <algorithm>
 #include <numeric>
@@ -114,6 +115,18 @@ const std::set<const recipe *> &recipe_subset::of_component( const itype_id &id
     return iter != component.end() ? iter->second : null_match;
 }
 
+const std::set<const recipe *> &recipe_subset::of_tool( const itype_id &id ) const
+{
+    auto iter = tool.find( id );
+    return iter != tool.end() ? iter->second : null_match;
+}
+
+const std::set<const recipe *> &recipe_subset::of_quality( const quality_id &id ) const
+{
+    auto iter = quality.find( id );
+    return iter != quality.end() ? iter->second : null_match;
+}
+
 void recipe_dictionary::load( JsonObject &jo, const std::string &src, bool uncraft )
 {
     bool strict = src == "core";
@@ -482,6 +495,16 @@ void recipe_subset::include( const recipe *r, int custom_difficulty )
                 component[comp.type].insert( r );
             }
         }
+        for( const auto &opts : r->requirements().get_tools() ) {
+            for( const tool_comp &comp : opts ) {
+                tool[comp.type].insert( r );
+            }
+        }
+        for( const auto &opts : r->requirements().get_qualities() ) {
+            for( const quality_requirement &qual : opts ) {
+                quality[qual.type].insert( r );
+            }
+        }
         category[r->category].insert( r );
         // Set the difficulty is it's not the default
         if( custom_difficulty != r->difficulty ) {
@@ -507,3 +530,44 @@ int recipe_subset::get_custom_difficulty( const recipe *r ) const
     }
     return r->difficulty;
 }
+
+void recipe_availability::update( const inventory &crafting_inv, const bool has_debug_hs )
+{
+    const std::shared_ptr<const inventory_index> index = crafting_inv.get_index();
+    if( !index || !last_index || has_debug_hs != debug_hs ) {
+        available.clear();
+        checked.clear();
+    } else if( index != last_index ) {
+        std::set<itype_id> types;
+        std::set<quality_id> qualities;
+        index->changes( *last_index, types, qualities );
+        for( const itype_id &type : types ) {
+            for( const recipe *r : checked.of_component( type ) ) {
+                available.erase( r );
+            }
+            for( const recipe *r : checked.of_tool( type ) ) {
+                available.erase( r );
+            }
+        }
+        for( const quality_id &qual : qualities ) {
+            for( const recipe *r : checked.of_quality( qual ) ) {
+                available.erase( r );
+            }
+        }
+    }
+    last_index = index;
+    debug_hs = has_debug_hs;
+}
+
+bool recipe_availability::can_make( const recipe *r, const inventory &crafting_inv )
+{
+    const auto iter = available.find( r );
+    if( iter != available.end() ) {
+        return iter->second;
+    }
+    const bool result = r->requirements().can_make_with_inventory( crafting_inv );
+    available.emplace( r, result );
+    checked.include( r );
+    num_checks++;
+    return result;
+}
@@ -1,15 +1,22 @@
 #ifndef RECIPE_DICTIONARY_H
 #define RECIPE_DICTIONARY_H
 
+#include "string_id.h"
+
 #include <string>
 #include <map>
 #include <functional>
+#include <memory>
 #include <set>
 #include <vector>
 
 class JsonObject;
+class inventory;
+struct inventory_index;
 struct recipe;
+struct quality;
 typedef std::string itype_id;
+using quality_id = string_id<quality>;
 
 class recipe_dictionary
 {
@@ -97,6 +104,10 @@ class recipe_subset
 
         /** Returns all recipes which could use component */
         const std::set<const recipe *> &of_component( const itype_id &id ) const;
+        /** Returns all recipes which could use the tool */
+        const std::set<const recipe *> &of_tool( const itype_id &id ) const;
+        /** Returns all recipes which require the tool quality */
+        const std::set<const recipe *> &of_quality( const quality_id &id ) const;
 
         enum class search_type {
             name,
@@ -117,6 +128,8 @@ class recipe_subset
 
         void clear() {
             component.clear();
+            tool.clear();
+            quality.clear();
             category.clear();
             recipes.clear();
         }
@@ -134,6 +147,55 @@ class recipe_subset
         std::map<const recipe *, int> difficulties;
         std::map<std::string, std::set<const recipe *>> category;
         std::map<itype_id, std::set<const recipe *>> component;
+        std::map<itype_id, std::set<const recipe *>> tool;
+        std::map<quality_id, std::set<const recipe *>> quality;
+};
+
+/**
+ * Remembers which recipes can be made (as a single batch) with the crafting inventory.
+ * When the inventory changes, only the recipes that use an item type or a quality whose
+ * totals have changed are checked again.
+ */
+class recipe_availability
+{
+    public:
+        /**
+         * Forgets about the recipes affected by the changes since the last call.
+         * Everything is forgotten if @p crafting_inv has no index, see @ref inventory::build_index.
+         * @param has_debug_hs Whether the crafter has the DEBUG_HS trait, which makes every
+         * recipe available. Everything is forgotten when it changes.
+         */
+        void update( const inventory &crafting_inv, bool has_debug_hs );
+
+        /** Same as requirement_data::can_make_with_inventory, checked only if not known yet. */
+        bool can_make( const recipe *r, const inventory &crafting_inv );
+
+        /**
+         * Makes the recipe to be checked again. Checking a recipe updates the availability
+         * of its components, so this is needed after checking it for another batch size.
+         */
+        void forget( const recipe *r ) {
+            available.erase( r );
+        }
+
+        /** Number of recipes that had to be checked so far. */
+        size_t checks() const {
+            return num_checks;
+        }
+
+        void clear() {
+            available.clear();
+            checked.clear();
+            last_index.reset();
+        }
+
+    private:
+        std::map<const recipe *, bool> available;
+        /** All recipes that have been checked, for finding the ones affected by a change. */
+        recipe_subset checked;
+        std::shared_ptr<const inventory_index> last_index;
+        bool debug_hs = false;
+        size_t num_checks = 0;
 };
 
 #endif
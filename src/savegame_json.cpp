@@ -1837,16 +1837,6 @@ void vehicle::deserialize(JsonIn &jsin)
     pivot_anchor[1] = pivot_anchor[0];
     pivot_rotation[1] = pivot_rotation[0] = fdir;
 
-    // Need to manually backfill the active item cache since the part loader can't call its vehicle.
-    for( auto cargo_index : all_parts_with_feature(VPFLAG_CARGO, true) ) {
-        auto it = parts[cargo_index].items.begin();
-        auto end = parts[cargo_index].items.end();
-        for( ; it != end; ++it ) {
-            if( it->needs_processing() ) {
-                active_items.add( it, parts[cargo_index].mount );
-            }
-        }
-    }
     /* After loading, check if the vehicle is from the old rules and is missing
      * frames. */
     if ( savegame_loading_version < 11 ) {
@@ -1860,6 +1850,17 @@ void vehicle::deserialize(JsonIn &jsin)
 
     refresh();
 
+    // Need to manually backfill the active item cache since the part loader can't call its vehicle.
+    for( auto cargo_index : all_parts_with_feature(VPFLAG_CARGO, true) ) {
+        auto it = parts[cargo_index].items.begin();
+        auto end = parts[cargo_index].items.end();
+        for( ; it != end; ++it ) {
+            if( it->needs_processing() ) {
+                active_items.add( it, parts[cargo_index].mount );
+            }
+        }
+    }
+
     data.read("tags", tags);
     data.read("labels", labels);
 
@@ -5,6 +5,7 @@
 #include "output.h"
 #include "game.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -124,11 +125,12 @@ void scent_map::update( const tripoint &center, map &m )
     player_last_position = center;
     player_last_moved = calendar::turn;
 
-    // note: the next four intermediate matrices need to be at least
-    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
+    // note: the intermediate matrices need to be at least
+    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+3] in size to hold enough data
     // The code I'm modifying used [SEEX * MAPSIZE]. I'm staying with that to avoid new bugs.
 
-    // These two matrices are transposed so that x addresses are contiguous in memory
+    // All loops below run over y in the inner loop, so they access contiguous memory.
+    // They have no branches, which allows the compiler to vectorize them.
     scent_array<int> sum_3_scent_y;
     scent_array<int> squares_used_y;
 
@@ -136,11 +138,16 @@ void scent_map::update( const tripoint &center, map &m )
     scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
     scent_array<bool> reduces_scent;
 
+    // Per-cell multipliers derived from the above
+    scent_array<int> weight;
+    scent_array<int> cell_diffusivity;
+
     // for loop constants
-    const int scentmap_minx = center.x - SCENT_RADIUS;
-    const int scentmap_maxx = center.x + SCENT_RADIUS;
-    const int scentmap_miny = center.y - SCENT_RADIUS;
-    const int scentmap_maxy = center.y + SCENT_RADIUS;
+    // The loops below also touch the squares next to the scent map, which must be on the map.
+    const int scentmap_minx = std::max( center.x - SCENT_RADIUS, 1 );
+    const int scentmap_maxx = std::min( center.x + SCENT_RADIUS, SEEX * MAPSIZE - 2 );
+    const int scentmap_miny = std::max( center.y - SCENT_RADIUS, 1 );
+    const int scentmap_maxy = std::min( center.y + SCENT_RADIUS, SEEY * MAPSIZE - 2 );
 
     // decrease this to reduce gas spread. Keep it under 125 for
     // stability. This is essentially a decimal number * 1000.
@@ -149,6 +156,16 @@ void scent_map::update( const tripoint &center, map &m )
     // The new scent flag searching function. Should be wayyy faster than the old one.
     m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
                       scentmap_maxx + 1, scentmap_maxy + 1 );
+    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+        for( int y = scentmap_miny - 1; y <= scentmap_maxy + 1; ++y ) {
+            // How much of the scent of this square diffuses: none on walls, only 20% on
+            // REDUCE_SCENT squares
+            weight[x][y] = blocks_scent[x][y] ? 0 : ( reduces_scent[x][y] ? 2 : 10 );
+            // less air movement for REDUCE_SCENT square
+            cell_diffusivity[x][y] = reduces_scent[x][y] ? diffusivity / 5 : diffusivity;
+        }
+    }
+
     // Sum neighbors in the y direction.  This way, each square gets called 3 times instead of 9
     // times. This cost us an extra loop here, but it also eliminated a loop at the end, so there
     // is a net performance improvement over the old code. Could probably still be better.
@@ -156,60 +173,43 @@ void scent_map::update( const tripoint &center, map &m )
     // than the final scent matrix. I think this is fine since SCENT_RADIUS is less than
     // SEEX*MAPSIZE, but if that changes, this may need tweaking.
     for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+        const auto &scent_col = grscent[x];
+        const auto &weight_col = weight[x];
         for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
             // remember the sum of the scent val for the 3 neighboring squares that can defuse into
-            sum_3_scent_y[y][x] = 0;
-            squares_used_y[y][x] = 0;
-            for( int i = y - 1; i <= y + 1; ++i ) {
-                if( !blocks_scent[x][i] ) {
-                    if( reduces_scent[x][i] ) {
-                        // only 20% of scent can diffuse on REDUCE_SCENT squares
-                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
-                        squares_used_y[y][x] += 2;
-                    } else {
-                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
-                        squares_used_y[y][x] += 10;
-                    }
-                }
-            }
+            sum_3_scent_y[x][y] = weight_col[y - 1] * scent_col[y - 1] +
+                                  weight_col[y] * scent_col[y] +
+                                  weight_col[y + 1] * scent_col[y + 1];
+            squares_used_y[x][y] = weight_col[y - 1] + weight_col[y] + weight_col[y + 1];
         }
     }
 
     // Rest of the scent map
     for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
+        auto &scent_col = grscent[x];
         for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            auto &scent_here = grscent[x][y];
-            if( !blocks_scent[x][y] ) {
-                // to how many neighboring squares do we diffuse out? (include our own square
-                // since we also include our own square when diffusing in)
-                int squares_used = squares_used_y[y][x - 1]
-                                   + squares_used_y[y][x]
-                                   + squares_used_y[y][x + 1];
-
-                int this_diffusivity;
-                if( !reduces_scent[x][y] ) {
-                    this_diffusivity = diffusivity;
-                } else {
-                    this_diffusivity = diffusivity / 5; //less air movement for REDUCE_SCENT square
-                }
-                int temp_scent;
-                // take the old scent and subtract what diffuses out
-                temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
-                // neighboring walls and reduce_scent squares absorb some scent
-                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
-                // we've already summed neighboring scent values in the y direction in the previous
-                // loop. Now we do it for the x direction, multiply by diffusion, and this is what
-                // diffuses into our current square.
-                scent_here =
-                    ( temp_scent
-                      + this_diffusivity * ( sum_3_scent_y[y][x - 1]
-                                             + sum_3_scent_y[y][x]
-                                             + sum_3_scent_y[y][x + 1] )
-                    ) / ( 1000 * 10 );
-            } else {
-                // this cell blocks scent
-                scent_here = 0;
-            }
+            // to how many neighboring squares do we diffuse out? (include our own square
+            // since we also include our own square when diffusing in)
+            const int squares_used = squares_used_y[x - 1][y]
+                                     + squares_used_y[x][y]
+                                     + squares_used_y[x + 1][y];
+
+            const int this_diffusivity = cell_diffusivity[x][y];
+            const int scent_here = scent_col[y];
+            // take the old scent and subtract what diffuses out
+            int temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+            // neighboring walls and reduce_scent squares absorb some scent
+            temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+            // we've already summed neighboring scent values in the y direction in the previous
+            // loop. Now we do it for the x direction, multiply by diffusion, and this is what
+            // diffuses into our current square.
+            // Cells that block scent have a weight of 0 and end up with no scent.
+            scent_col[y] =
+                ( temp_scent
+                  + this_diffusivity * ( sum_3_scent_y[x - 1][y]
+                                         + sum_3_scent_y[x][y]
+                                         + sum_3_scent_y[x + 1][y] )
+                ) / ( 1000 * 10 ) * ( weight[x][y] != 0 );
         }
     }
 }
@@ -20,6 +20,7 @@
 #include "time.h"
 #include "mapdata.h"
 #include "itype.h"
+#include "creature_tracker.h"
 #include <chrono>
 #include <algorithm>
 
@@ -160,6 +161,47 @@ static std::vector<centroid> cluster_sounds( std::vector<std::pair<tripoint, int
     return sound_clusters;
 }
 
+// Volume lost to each opaque tile between a sound and a listener
+static constexpr int WALL_ATTENUATION = 15;
+
+static int muffled_volume( const tripoint &source, const tripoint &listener, int volume )
+{
+    if( source.z != listener.z || !g->m.inbounds( source ) || !g->m.inbounds( listener ) ) {
+        return volume;
+    }
+    const auto &transparency_cache = g->m.get_cache_ref( source.z ).transparency_cache;
+    for( const tripoint &p : line_to( source, listener ) ) {
+        if( p != listener && transparency_cache[p.x][p.y] <= LIGHT_TRANSPARENCY_SOLID ) {
+            volume -= WALL_ATTENUATION;
+        }
+    }
+    return volume;
+}
+
+std::vector<std::pair<int, int>> sounds::monster_listeners( const tripoint &source,
+        const int volume )
+{
+    std::vector<std::pair<int, int>> result;
+    if( volume <= 0 ) {
+        return result;
+    }
+    const bool muffle = get_option<bool>( "SOUNDS_MUFFLED_BY_WALLS" );
+    // Monsters further away than twice the volume certainly won't hear the sound.
+    // Only the monsters within that square have to be checked.
+    for( const int i : g->critter_tracker->find_in_radius( source, volume * 2 ) ) {
+        const tripoint &pos = g->zombie( i ).pos();
+        const int dist = rl_dist( source, pos );
+        if( volume * 2 <= dist ) {
+            continue;
+        }
+        const int heard = muffle ? muffled_volume( source, pos, volume ) : volume;
+        if( heard * 2 > dist ) {
+            result.emplace_back( i, heard );
+        }
+    }
+    return result;
+}
+
 void sounds::process_sounds()
 {
     std::vector<centroid> sound_clusters = cluster_sounds( recent_sounds );
@@ -182,13 +224,9 @@ void sounds::process_sounds()
             overmap_buffer.signal_hordes( target, sig_power );
         }
         // Alert all monsters (that can hear) to the sound.
-        for (int i = 0, numz = g->num_zombies(); i < numz; i++) {
-            monster &critter = g->zombie(i);
-            const int dist = rl_dist( source, critter.pos() );
-            if( vol * 2 > dist ) {
-                // Exclude monsters that certainly won't hear the sound
-                critter.hear_sound( source, vol, dist );
-            }
+        for( const auto &listener : monster_listeners( source, vol ) ) {
+            monster &critter = g->zombie( listener.first );
+            critter.hear_sound( source, listener.second, rl_dist( source, critter.pos() ) );
         }
     }
     recent_sounds.clear();
@@ -41,6 +41,12 @@ void reset_markers();
 void process_sounds();
 // process_sound_markers applies sound events to the player and records them for display.
 void process_sound_markers( player *p );
+/**
+ * Monsters that may hear a sound of the given volume (already reduced by the weather),
+ * as pairs of monster index and the volume that reaches them, ordered by index.
+ * If the option is enabled, walls between the sound and a monster muffle the sound.
+ */
+std::vector<std::pair<int, int>> monster_listeners( const tripoint &source, int volume );
 
 // Return list of points that have sound events the player can hear.
 std::vector<tripoint> get_footstep_markers();
@@ -51,6 +51,7 @@ struct submap {
 
     void set_trap( const int x, const int y, trap_id trap ) {
         is_uniform = false;
+        is_dirty = true;
         trp[x][y] = trap;
     }
 
@@ -60,6 +61,7 @@ struct submap {
 
     void set_furn( const int x, const int y, furn_id furn ) {
         is_uniform = false;
+        is_dirty = true;
         frn[x][y] = furn;
     }
 
@@ -69,6 +71,7 @@ struct submap {
 
     void set_ter( const int x, const int y, ter_id terr ) {
         is_uniform = false;
+        is_dirty = true;
         ter[x][y] = terr;
     }
 
@@ -78,11 +81,13 @@ struct submap {
 
     void set_radiation( const int x, const int y, const int radiation ) {
         is_uniform = false;
+        is_dirty = true;
         rad[x][y] = radiation;
     }
 
     void update_lum_add( item const &i, int const x, int const y ) {
         is_uniform = false;
+        is_dirty = true;
         if (i.is_emissive() && lum[x][y] < 255) {
             lum[x][y]++;
         }
@@ -90,6 +95,7 @@ struct submap {
 
     void update_lum_rem( item const &i, int const x, int const y ) {
         is_uniform = false;
+        is_dirty = true;
         if (!i.is_emissive()) {
             return;
         } else if (lum[x][y] && lum[x][y] < 255) {
@@ -140,11 +146,13 @@ struct submap {
     // Can be used anytime (prevents code from needing to place sign first.)
     void set_signage( const int x, const int y, std::string s) {
         is_uniform = false;
+        is_dirty = true;
         cosmetics[x][y]["SIGNAGE"] = s;
     }
     // Can be used anytime (prevents code from needing to place sign first.)
     void delete_signage( const int x, const int y) {
         is_uniform = false;
+        is_dirty = true;
         cosmetics[x][y].erase("SIGNAGE");
     }
 
@@ -160,6 +168,9 @@ struct submap {
     // If is_uniform is true, this submap is a solid block of terrain
     // Uniform submaps aren't saved/loaded, because regenerating them is faster
     bool is_uniform;
+    // If is_dirty is true, this submap was changed (or never written) since it was last saved.
+    // Submaps that are not dirty are skipped by mapbuffer::save, their file is still up to date.
+    bool is_dirty = true;
 
     std::map<std::string, std::string> cosmetics[SEEX][SEEY]; // Textual "visuals" for each square.
 
@@ -0,0 +1,269 @@
+#include "turn_profiler.h"
+
+#include "calendar.h"
+#include "cata_utility.h"
+#include "json.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace turn_profiler
+{
+
+bool profiling_enabled = false;
+
+namespace
+{
+
+constexpr int num_stages = static_cast<int>( stage::num_stages );
+/** Number of turns kept for the percentile statistics. */
+constexpr size_t history_size = 1024;
+/** Maximal number of individual timer spans kept for the trace export. */
+constexpr size_t trace_buffer_size = 1 << 16;
+
+using clock = std::chrono::steady_clock;
+
+struct trace_event {
+    int turn;
+    stage st;
+    int depth;
+    int64_t start_us;
+    int64_t duration_us;
+};
+
+struct turn_record {
+    std::array<int64_t, num_stages> duration_us;
+    std::array<int, num_stages> calls;
+};
+
+struct profiler_state {
+    clock::time_point epoch;
+    int depth = 0;
+
+    turn_record current = {};
+
+    std::vector<turn_record> history;
+    size_t history_next = 0;
+
+    std::vector<trace_event> events;
+    size_t events_next = 0;
+
+    void reset() {
+        epoch = clock::now();
+        depth = 0;
+        current = turn_record();
+        history.clear();
+        history_next = 0;
+        events.clear();
+        events_next = 0;
+    }
+};
+
+profiler_state &state()
+{
+    static profiler_state instance;
+    return instance;
+}
+
+int64_t to_us( const clock::duration &d )
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>( d ).count();
+}
+
+/** Value at the given quantile of the (modified) input, 0 on empty input. */
+int64_t quantile( std::vector<int64_t> &values, const double q )
+{
+    if( values.empty() ) {
+        return 0;
+    }
+    const size_t index = std::min( values.size() - 1, static_cast<size_t>( q * values.size() ) );
+    std::nth_element( values.begin(), values.begin() + index, values.end() );
+    return values[index];
+}
+
+} // namespace
+
+const char *stage_name( const stage s )
+{
+    switch( s ) {
+        case stage::process_events:
+            return "process_events";
+        case stage::missions:
+            return "mission::process_all";
+        case stage::mongroups:
+            return "process_mongroups";
+        case stage::move_hordes:
+            return "move_hordes";
+        case stage::autosave:
+            return "autosave";
+        case stage::weather:
+            return "update_weather";
+        case stage::activity:
+            return "process_activity";
+        case stage::scent:
+            return "scent_map::update";
+        case stage::floor_caches:
+            return "build_floor_caches";
+        case stage::falling:
+            return "process_falling";
+        case stage::vehmove:
+            return "vehmove";
+        case stage::map_prefetch:
+            return "map_prefetch";
+        case stage::map_evict:
+            return "mapbuffer::evict_unused";
+        case stage::vehicle_idle:
+            return "vehicle_idle";
+        case stage::fields:
+            return "process_fields";
+        case stage::active_items:
+            return "process_active_items";
+        case stage::sounds:
+            return "process_sounds";
+        case stage::map_cache:
+            return "build_map_cache";
+        case stage::monmove:
+            return "monmove";
+        case stage::monster_plan:
+            return "monster::plan";
+        case stage::route:
+            return "map::route";
+        case stage::flow_field:
+            return "flow_field";
+        case stage::player_turn:
+            return "player::process_turn";
+        case stage::player_upkeep:
+            return "player_upkeep";
+        case stage::num_stages:
+            break;
+    }
+    return "unknown";
+}
+
+void set_enabled( const bool enable )
+{
+    if( enable && !profiling_enabled ) {
+        state().reset();
+    }
+    profiling_enabled = enable;
+}
+
+void clear()
+{
+    state().reset();
+}
+
+void end_turn()
+{
+    if( !profiling_enabled ) {
+        return;
+    }
+    profiler_state &s = state();
+    if( s.history.size() < history_size ) {
+        s.history.push_back( s.current );
+    } else {
+        s.history[s.history_next] = s.current;
+    }
+    s.history_next = ( s.history_next + 1 ) % history_size;
+    s.current = turn_record();
+}
+
+int recorded_turns()
+{
+    return state().history.size();
+}
+
+stage_summary summarize( const stage st )
+{
+    const profiler_state &s = state();
+    const int index = static_cast<int>( st );
+
+    stage_summary result;
+    result.turns = s.history.size();
+    if( s.history.empty() ) {
+        return result;
+    }
+
+    std::vector<int64_t> durations;
+    durations.reserve( s.history.size() );
+    int64_t calls = 0;
+    for( const turn_record &rec : s.history ) {
+        durations.push_back( rec.duration_us[index] );
+        calls += rec.calls[index];
+    }
+
+    result.calls_per_turn = static_cast<double>( calls ) / result.turns;
+    result.max_ms = *std::max_element( durations.begin(), durations.end() ) / 1000.0;
+    result.p50_ms = quantile( durations, 0.50 ) / 1000.0;
+    result.p99_ms = quantile( durations, 0.99 ) / 1000.0;
+    return result;
+}
+
+bool write_chrome_trace( const std::string &path )
+{
+    const profiler_state &s = state();
+    return write_to_file( path, [&]( std::ostream & fout ) {
+        JsonOut jsout( fout );
+        jsout.start_object();
+        jsout.member( "displayTimeUnit", "ms" );
+        jsout.member( "traceEvents" );
+        jsout.start_array();
+        // Oldest event first: once the ring buffer has wrapped, that's the one at events_next.
+        const size_t count = s.events.size();
+        const size_t first = count < trace_buffer_size ? 0 : s.events_next;
+        for( size_t i = 0; i < count; ++i ) {
+            const trace_event &ev = s.events[( first + i ) % count];
+            jsout.start_object();
+            jsout.member( "name", stage_name( ev.st ) );
+            jsout.member( "cat", "turn" );
+            jsout.member( "ph", "X" );
+            jsout.member( "ts", static_cast<long>( ev.start_us ) );
+            jsout.member( "dur", static_cast<long>( ev.duration_us ) );
+            jsout.member( "pid", 1 );
+            jsout.member( "tid", 1 );
+            jsout.member( "args" );
+            jsout.start_object();
+            jsout.member( "turn", ev.turn );
+            jsout.member( "depth", ev.depth );
+            jsout.end_object();
+            jsout.end_object();
+        }
+        jsout.end_array();
+        jsout.end_object();
+    }, "turn profiler trace" );
+}
+
+void scoped_timer::start()
+{
+    state().depth++;
+    begin = clock::now();
+}
+
+void scoped_timer::stop()
+{
+    const clock::time_point end = clock::now();
+    profiler_state &s = state();
+    s.depth--;
+    // Profiling may have been (re)enabled while this timer was running.
+    if( !profiling_enabled || begin < s.epoch ) {
+        s.depth = std::max( s.depth, 0 );
+        return;
+    }
+
+    const int index = static_cast<int>( st );
+    const int64_t duration = to_us( end - begin );
+    s.current.duration_us[index] += duration;
+    s.current.calls[index]++;
+
+    const trace_event ev{ static_cast<int>( calendar::turn ), st, s.depth, to_us( begin - s.epoch ), duration };
+    if( s.events.size() < trace_buffer_size ) {
+        s.events.push_back( ev );
+    } else {
+        s.events[s.events_next] = ev;
+    }
+    s.events_next = ( s.events_next + 1 ) % trace_buffer_size;
+}
+
+}
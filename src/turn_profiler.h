@@ -0,0 +1,135 @@
+#ifndef TURN_PROFILER_H
+#define TURN_PROFILER_H
+
+#include <chrono>
+#include <string>
+
+/**
+ * Lightweight instrumentation of the per-turn game loop.
+ *
+ * Every stage of @ref game::do_turn (and a few hot nested calls such as
+ * monster planning and path finding) is wrapped in a @ref turn_profiler::scoped_timer.
+ * While profiling is disabled (the default) a timer costs a single branch on a global flag.
+ * While enabled, the accumulated time of each stage is committed once per turn into a rolling
+ * history (used to compute percentiles) and every individual timer span is appended to a
+ * ring buffer of trace events, which can be written out in the Chrome trace-event format
+ * (load it in chrome://tracing or any compatible viewer).
+ */
+namespace turn_profiler
+{
+
+enum class stage : int {
+    process_events = 0,
+    missions,
+    mongroups,
+    move_hordes,
+    autosave,
+    weather,
+    activity,
+    scent,
+    floor_caches,
+    falling,
+    vehmove,
+    map_prefetch,
+    map_evict,
+    vehicle_idle,
+    fields,
+    active_items,
+    sounds,
+    map_cache,
+    monmove,
+    monster_plan,
+    route,
+    flow_field,
+    player_turn,
+    player_upkeep,
+    num_stages
+};
+
+/** Human readable (untranslated) name of the stage, used in reports and traces. */
+const char *stage_name( stage s );
+
+/** Percentiles of the per-turn cost of a stage, over the turns in the history. */
+struct stage_summary {
+    /** Number of turns in the history. */
+    int turns = 0;
+    /** Average number of times the stage was entered per turn. */
+    double calls_per_turn = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+/** Don't access directly, use @ref is_enabled. Only exposed to keep the disabled timers cheap. */
+extern bool profiling_enabled;
+
+inline bool is_enabled()
+{
+    return profiling_enabled;
+}
+/** Enables or disables profiling. Enabling starts with an empty history. */
+void set_enabled( bool enable );
+/** Discards all recorded history and trace events. */
+void clear();
+/**
+ * Commits the time accumulated by all stages since the previous call as one turn of history.
+ * Called once at the end of each @ref game::do_turn, see @ref turn_scope.
+ */
+void end_turn();
+
+stage_summary summarize( stage s );
+/** Number of turns currently stored in the rolling history. */
+int recorded_turns();
+
+/**
+ * Writes the buffered trace events as Chrome trace-event JSON to the given file.
+ * @return Whether the file was written successfully (errors are reported via a popup).
+ */
+bool write_chrome_trace( const std::string &path );
+
+/**
+ * Measures the time from its construction to its destruction and attributes it to a stage.
+ * Timers can be nested, the nesting depth is recorded in the trace.
+ */
+class scoped_timer
+{
+    public:
+        scoped_timer( stage s ) : st( s ), active( profiling_enabled ) {
+            if( active ) {
+                start();
+            }
+        }
+        ~scoped_timer() {
+            if( active ) {
+                stop();
+            }
+        }
+
+        scoped_timer( const scoped_timer & ) = delete;
+        scoped_timer &operator=( const scoped_timer & ) = delete;
+
+    private:
+        void start();
+        void stop();
+
+        stage st;
+        bool active;
+        std::chrono::steady_clock::time_point begin;
+};
+
+/** Calls @ref end_turn when it goes out of scope, whichever way the turn is left. */
+class turn_scope
+{
+    public:
+        turn_scope() = default;
+        ~turn_scope() {
+            end_turn();
+        }
+
+        turn_scope( const turn_scope & ) = delete;
+        turn_scope &operator=( const turn_scope & ) = delete;
+};
+
+}
+
+#endif
@@ -309,10 +309,7 @@ void vpart_info::finalize()
             e.second.list_order = 5;
         }
     }
-}
 
-void vpart_info::check()
-{
     for( auto &vp : vpart_info_all ) {
         auto &part = vp.second;
 
@@ -369,6 +366,13 @@ void vpart_info::check()
         if( part.removal_moves < 0 ) {
             part.removal_moves = part.install_moves / 2;
         }
+    }
+}
+
+void vpart_info::check()
+{
+    for( auto &vp : vpart_info_all ) {
+        auto &part = vp.second;
 
         for( auto &e : part.install_skills ) {
             if( !e.first.is_valid() ) {
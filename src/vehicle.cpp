@@ -2081,9 +2081,13 @@ int vehicle::part_with_feature_at_relative (const point &pt, const std::string &
 
 bool vehicle::has_part( const std::string &flag, bool enabled ) const
 {
-    return std::any_of( parts.begin(), parts.end(), [&flag,&enabled]( const vehicle_part &e ) {
-        return !e.removed && !e.is_broken() && ( !enabled || e.enabled ) && e.info().has_flag( flag );
-    } );
+    for( const int p : parts_with_feature( flag ) ) {
+        const vehicle_part &e = parts[ p ];
+        if( !e.removed && !e.is_broken() && ( !enabled || e.enabled ) ) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool vehicle::has_part( const tripoint &pos, const std::string &flag, bool enabled ) const
@@ -2105,8 +2109,9 @@ bool vehicle::has_part( const tripoint &pos, const std::string &flag, bool enabl
 std::vector<vehicle_part *> vehicle::get_parts( const std::string &flag, bool enabled )
 {
     std::vector<vehicle_part *> res;
-    for( auto &e : parts ) {
-        if( !e.removed && !e.is_broken() && ( !enabled || e.enabled ) && e.info().has_flag( flag ) ) {
+    for( const int p : parts_with_feature( flag ) ) {
+        vehicle_part &e = parts[ p ];
+        if( !e.removed && !e.is_broken() && ( !enabled || e.enabled ) ) {
             res.push_back( &e );
         }
     }
@@ -2116,8 +2121,9 @@ std::vector<vehicle_part *> vehicle::get_parts( const std::string &flag, bool en
 std::vector<const vehicle_part *> vehicle::get_parts( const std::string &flag, bool enabled ) const
 {
     std::vector<const vehicle_part *> res;
-    for( const auto &e : parts ) {
-        if( !e.removed && !e.is_broken() && ( !enabled || e.enabled ) && e.info().has_flag( flag ) ) {
+    for( const int p : parts_with_feature( flag ) ) {
+        const vehicle_part &e = parts[ p ];
+        if( !e.removed && !e.is_broken() && ( !enabled || e.enabled ) ) {
             res.push_back( &e );
         }
     }
@@ -2248,10 +2254,9 @@ int vehicle::next_part_to_open(int p, bool outside) const
 
 /**
  * Returns all parts in the vehicle with the given flag, optionally checking
- * to only return unbroken parts.
- * If performance becomes an issue, certain lists (such as wheels) could be
- * cached and fast-returned here, but this is currently linear-time with
- * respect to the number of parts in the vehicle.
+ * to only return unbroken parts. The parts are taken from the lists kept by
+ * @ref refresh, so this is linear-time with respect to the number of parts
+ * with the flag.
  * @param feature The flag (such as "WHEEL" or "CONE_LIGHT") to find.
  * @param unbroken true if only unbroken parts should be returned, false to
  *        return all matching parts.
@@ -2259,11 +2264,14 @@ int vehicle::next_part_to_open(int p, bool outside) const
  */
 std::vector<int> vehicle::all_parts_with_feature(const std::string& feature, bool const unbroken) const
 {
+    const std::vector<int> &found = parts_with_feature( feature );
+    if( !unbroken ) {
+        return found;
+    }
     std::vector<int> parts_found;
-    for( size_t part_index = 0; part_index < parts.size(); ++part_index ) {
-        if(part_info(part_index).has_flag(feature) &&
-                ( !unbroken || !parts[ part_index ].is_broken() ) ) {
-            parts_found.push_back(part_index);
+    for( const int p : found ) {
+        if( !parts[ p ].is_broken() ) {
+            parts_found.push_back( p );
         }
     }
     return parts_found;
@@ -2271,16 +2279,40 @@ std::vector<int> vehicle::all_parts_with_feature(const std::string& feature, boo
 
 std::vector<int> vehicle::all_parts_with_feature(vpart_bitflags feature, bool const unbroken) const
 {
+    const std::vector<int> &found = parts_with_feature( feature );
+    if( !unbroken ) {
+        return found;
+    }
     std::vector<int> parts_found;
-    for( size_t part_index = 0; part_index < parts.size(); ++part_index ) {
-        if(part_info(part_index).has_flag(feature) &&
-                ( !unbroken || !parts[ part_index ].is_broken() ) ) {
-            parts_found.push_back(part_index);
+    for( const int p : found ) {
+        if( !parts[ p ].is_broken() ) {
+            parts_found.push_back( p );
         }
     }
     return parts_found;
 }
 
+const std::vector<int> &vehicle::parts_with_feature( const std::string &feature ) const
+{
+    const auto iter = named_feature_parts.find( feature );
+    if( iter != named_feature_parts.end() ) {
+        return iter->second;
+    }
+    // Only the flags that are actually asked for get a list, the lists are dropped by refresh.
+    std::vector<int> &found = named_feature_parts[ feature ];
+    for( size_t p = 0; p < parts.size(); ++p ) {
+        if( part_info( p ).has_flag( feature ) ) {
+            found.push_back( p );
+        }
+    }
+    return found;
+}
+
+const std::vector<int> &vehicle::parts_with_feature( vpart_bitflags const feature ) const
+{
+    return feature_parts[ feature ];
+}
+
 /**
  * Returns all parts in the vehicle that exist in the given location slot. If
  * the empty string is passed in, returns all parts with no slot.
@@ -3552,6 +3584,31 @@ void vehicle::power_parts()
     }
 }
 
+bool vehicle::needs_upkeep() const
+{
+    if( engine_on || is_alarm_on || camera_on ) {
+        return true;
+    }
+    static const std::array<std::string, 7> powered_flags = {{
+        "SCOOP", "RECHARGE", "FRIDGE", "STEREO", "CHIMES", "PLANTER", "REACTOR"
+    }};
+    for( const vehicle_part &pt : parts ) {
+        if( pt.removed || pt.is_broken() || !pt.enabled ) {
+            continue;
+        }
+        if( pt.is_light() ) {
+            return true;
+        }
+        const vpart_info &vp = pt.info();
+        for( const std::string &flag : powered_flags ) {
+            if( vp.has_flag( flag ) ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 vehicle* vehicle::find_vehicle( const tripoint &where )
 {
     // Is it in the reality bubble?
@@ -4961,6 +5018,11 @@ void vehicle::refresh()
     steering.clear();
     speciality.clear();
     floating.clear();
+    feature_parts.resize( NUM_VPFLAGS );
+    for( auto &e : feature_parts ) {
+        e.clear();
+    }
+    named_feature_parts.clear();
     tracking_epower = 0;
     alternator_load = 0;
     camera_epower = 0;
@@ -4977,6 +5039,11 @@ void vehicle::refresh()
     // Main loop over all vehicle parts.
     for( size_t p = 0; p < parts.size(); p++ ) {
         const vpart_info& vpi = part_info( p );
+        for( int f = 0; f < NUM_VPFLAGS; f++ ) {
+            if( vpi.has_flag( static_cast<vpart_bitflags>( f ) ) ) {
+                feature_parts[ f ].push_back( p );
+            }
+        }
         if( parts[p].removed ) {
             continue;
         }
@@ -16,6 +16,7 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <string>
 #include <iosfwd>
@@ -682,6 +683,14 @@ public:
     std::vector<int> all_parts_with_feature(const std::string &feature, bool unbroken = true) const;
     std::vector<int> all_parts_with_feature(vpart_bitflags f, bool unbroken = true) const;
 
+    /**
+     * Indices of all parts with the given flag, including broken and removed parts.
+     * Unlike @ref all_parts_with_feature this does not copy anything, the list is rebuilt
+     * by @ref refresh, so it changes when parts are installed or removed.
+     */
+    const std::vector<int> &parts_with_feature( const std::string &feature ) const;
+    const std::vector<int> &parts_with_feature( vpart_bitflags f ) const;
+
     // returns indices of all parts in the given location slot
     std::vector<int> all_parts_at_location(const std::string &location) const;
 
@@ -786,6 +795,13 @@ public:
 
     void power_parts();
 
+    /**
+     * Whether @ref power_parts or @ref idle can change the state of this vehicle while it is
+     * parked outside the reality bubble (running engine, alarm, camera or any enabled part that
+     * produces or consumes power).
+     */
+    bool needs_upkeep() const;
+
     /**
      * Try to charge our (and, optionally, connected vehicles') batteries by the given amount.
      * @return amount of charge left over.
@@ -1147,6 +1163,8 @@ public:
     std::vector<int> steering;         // List of STEERABLE parts
     std::vector<int> speciality;       // List of parts that will not be on a vehicle very often, or which only one will be present
     std::vector<int> floating;         // List of parts that provide buoyancy to boats
+    std::vector<std::vector<int>> feature_parts; // parts_with_feature, indexed by vpart_bitflags
+    mutable std::unordered_map<std::string, std::vector<int>> named_feature_parts; // parts_with_feature, filled on demand
     std::set<std::string> tags;        // Properties of the vehicle
 
     active_item_cache active_items;
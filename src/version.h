@@ -0,0 +1 @@
+#define VERSION "e1d7e22-dirty"
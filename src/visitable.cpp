@@ -121,6 +121,10 @@ bool visitable<T>::has_quality( const quality_id &qual, int level, int qty ) con
 template <>
 bool visitable<inventory>::has_quality( const quality_id &qual, int level, int qty ) const
 {
+    const auto index = static_cast<const inventory *>( this )->get_index();
+    if( index && qty > 0 ) {
+        return index->has_quality( qual, level, qty );
+    }
     long res = 0;
     for( const auto &stack : static_cast<const inventory *>( this )->items ) {
         res += stack.size() * has_quality_internal( stack.front(), qual, level, qty );
@@ -485,6 +489,7 @@ std::list<item> visitable<inventory>::remove_items_with( const
     if( count <= 0 ) {
         return res; // nothing to do
     }
+    inv->index.reset();
 
     for( auto stack = inv->items.begin(); stack != inv->items.end() && count > 0; ) {
         std::list<item> &istack = *stack;
@@ -721,6 +726,9 @@ long visitable<T>::charges_of( const std::string &what, int limit ) const
 template <>
 long visitable<inventory>::charges_of( const std::string &what, int limit ) const
 {
+    if( const auto index = static_cast<const inventory *>( this )->get_index() ) {
+        return std::min( index->charges_of( what ), long( limit ) );
+    }
     long res = 0;
     for( const auto &stack : static_cast<const inventory *>( this )->items ) {
         res += stack.size() * charges_of_internal( stack.front(), what, limit );
@@ -775,6 +783,9 @@ int visitable<T>::amount_of( const std::string& what, bool pseudo, int limit ) c
 template <>
 int visitable<inventory>::amount_of( const std::string& what, bool pseudo, int limit ) const
 {
+    if( const auto index = static_cast<const inventory *>( this )->get_index() ) {
+        return std::min( index->amount_of( what, pseudo ), limit );
+    }
     int res = 0;
     for( const auto &stack : static_cast<const inventory *>( this )->items ) {
         res += stack.size() * stack.front().amount_of( what, pseudo, limit );
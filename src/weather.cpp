@@ -17,6 +17,8 @@
 
 #include <vector>
 #include <sstream>
+#include <map>
+#include <unordered_map>
 
 const efftype_id effect_glare( "glare" );
 const efftype_id effect_blind( "blind" );
@@ -58,6 +60,274 @@ void weather_effect::glare()
 
 int get_hourly_rotpoints_at_temp( int temp );
 
+namespace
+{
+
+/** Sunlight of the minutes in an hour, see @ref sunlight_during. */
+struct sun_hour {
+    float sum = 0.0f;
+    float min = 0.0f;
+    float max = 0.0f;
+};
+
+/**
+ * The weather of one region (an overmap terrain) by hour, extended when needed. It keeps
+ * running totals, so the rot and weather sums of whole hours are a difference of two
+ * entries. Everything in an hour is sampled at the start of the hour.
+ */
+class weather_timeline
+{
+    public:
+        weather_timeline( const tripoint &location ) : location( location ) { }
+
+        /** Makes sure the hours from first to last (inclusive) are known. */
+        void extend( int first, int last );
+        /** Number of hours @ref extend would add. */
+        int missing( const int first, const int last ) const {
+            if( hours.empty() ) {
+                return last - first + 1;
+            }
+            const int known_last = first_hour + hours.size() - 1;
+            return std::max( 0, first_hour - first ) + std::max( 0, last - known_last );
+        }
+
+        /** Rot points, as in @ref get_rot_since. */
+        int rot_since( int startturn, int endturn ) const;
+        /** Same as @ref sum_conditions over the whole hours from first to last (exclusive). */
+        weather_sum sum( int first, int last ) const;
+
+    private:
+        struct hour_data {
+            weather_type type;
+            int rot;
+        };
+
+        const hour_data &at( int hour ) const {
+            return hours[hour - first_hour];
+        }
+        hour_data compute( int hour ) const;
+        void add_totals( const hour_data &data, int hour );
+
+        /** Where the weather is sampled, in absolute map squares. */
+        tripoint location;
+        int first_hour = 0;
+        std::vector<hour_data> hours;
+        /** Totals of the hours before the index, one more entry than @ref hours. */
+        std::vector<long long> rot_total;
+        std::vector<long long> rain_total;
+        std::vector<long long> acid_total;
+        std::vector<double> sunlight_total;
+};
+
+/** All the timelines for the current weather generator and seed. */
+struct weather_timelines {
+    weather_generator wgen;
+    unsigned seed = 0;
+    bool valid = false;
+    std::map<point, weather_timeline> regions;
+    /** Hours known by all the regions together. */
+    int hours = 0;
+    /** Independent of the region, by hour. */
+    std::unordered_map<int, sun_hour> sun;
+};
+
+weather_timelines timelines;
+
+/** Same as weather_generator::get_weather_conditions, from an already generated point. */
+weather_type conditions_at( const w_point &w, const calendar &t )
+{
+    const weather_type wt = timelines.wgen.get_weather_conditions( w );
+    // Make sure we don't say it's sunny at night!
+    if( wt == WEATHER_SUNNY && t.is_night() ) {
+        return WEATHER_CLEAR;
+    }
+    return wt;
+}
+
+/** Only the time of the sample is used from the calendar. */
+float sunlight_at( const int turn )
+{
+    return calendar( turn ).sunlight();
+}
+
+const sun_hour &sun_at( const int hour )
+{
+    const auto iter = timelines.sun.find( hour );
+    if( iter != timelines.sun.end() ) {
+        return iter->second;
+    }
+    sun_hour data;
+    for( int minute = 0; minute < 60; minute++ ) {
+        const float s = sunlight_at( HOURS( hour ) + MINUTES( minute ) );
+        data.sum += s;
+        data.min = minute == 0 ? s : std::min( data.min, s );
+        data.max = minute == 0 ? s : std::max( data.max, s );
+    }
+    return timelines.sun.emplace( hour, data ).first->second;
+}
+
+/** Sunlight over [from, to) minus the weather's light modifier, sampled every minute. */
+float sunlight_during( const int from, const int to, const weather_type wtype )
+{
+    const int modifier = weather_data( wtype ).light_modifier;
+    float result = 0.0f;
+    for( int turn = from; turn < to; turn += MINUTES( 1 ) ) {
+        result += std::min( MINUTES( 1 ), to - turn ) * std::max( 0.0f, sunlight_at( turn ) - modifier );
+    }
+    return result;
+}
+
+float sunlight_of_hour( const int hour, const weather_type wtype )
+{
+    const int modifier = weather_data( wtype ).light_modifier;
+    const sun_hour &sun = sun_at( hour );
+    if( sun.max <= modifier ) {
+        return 0.0f;
+    } else if( sun.min >= modifier ) {
+        return MINUTES( 1 ) * ( sun.sum - 60 * modifier );
+    }
+    return sunlight_during( HOURS( hour ), HOURS( hour + 1 ), wtype );
+}
+
+int rain_per_turn( const weather_type wtype )
+{
+    switch( wtype ) {
+        case WEATHER_DRIZZLE:
+            return 4;
+        case WEATHER_RAINY:
+        case WEATHER_THUNDER:
+        case WEATHER_LIGHTNING:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+int acid_per_turn( const weather_type wtype )
+{
+    switch( wtype ) {
+        case WEATHER_ACID_DRIZZLE:
+            return 4;
+        case WEATHER_ACID_RAIN:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Limit of @ref weather_timelines::hours, about 40 bytes each. All the regions are dropped
+ * when it's reached, longer intervals are not cached at all.
+ */
+const int max_timeline_hours = 24 * 365 * 2;
+
+/**
+ * The timeline of the region around the location, extended to the hours from first to last
+ * (inclusive). The regions are small compared to the scale of the weather noise, their
+ * weather is taken from their center.
+ */
+weather_timeline &timeline_at( const tripoint &location, const int first, const int last )
+{
+    const weather_generator &wgen = g->get_cur_weather_gen();
+    const unsigned seed = g->get_seed();
+    const point omt = ms_to_omt_copy( point( location.x, location.y ) );
+    const auto found = timelines.regions.find( omt );
+    const int missing = found == timelines.regions.end() ? last - first + 1 :
+                        found->second.missing( first, last );
+    if( !timelines.valid || timelines.seed != seed ||
+        timelines.wgen.base_temperature != wgen.base_temperature ||
+        timelines.wgen.base_humidity != wgen.base_humidity ||
+        timelines.wgen.base_pressure != wgen.base_pressure ||
+        timelines.wgen.base_acid != wgen.base_acid ||
+        timelines.hours + missing > max_timeline_hours ) {
+        timelines.regions.clear();
+        timelines.sun.clear();
+        timelines.hours = 0;
+        timelines.wgen = wgen;
+        timelines.seed = seed;
+        timelines.valid = true;
+    }
+    auto iter = timelines.regions.find( omt );
+    if( iter == timelines.regions.end() ) {
+        const tripoint center( omt.x * SEEX * 2 + SEEX, omt.y * SEEY * 2 + SEEY, 0 );
+        iter = timelines.regions.emplace( omt, weather_timeline( center ) ).first;
+    }
+    timelines.hours += iter->second.missing( first, last );
+    iter->second.extend( first, last );
+    return iter->second;
+}
+
+weather_timeline::hour_data weather_timeline::compute( const int hour ) const
+{
+    const calendar t( HOURS( hour ) );
+    const w_point w = timelines.wgen.get_weather( location, t, timelines.seed );
+    return hour_data{ conditions_at( w, t ), get_hourly_rotpoints_at_temp( w.temperature ) };
+}
+
+void weather_timeline::add_totals( const hour_data &data, const int hour )
+{
+    rot_total.push_back( rot_total.back() + data.rot );
+    rain_total.push_back( rain_total.back() + rain_per_turn( data.type ) * HOURS( 1 ) );
+    acid_total.push_back( acid_total.back() + acid_per_turn( data.type ) * HOURS( 1 ) );
+    sunlight_total.push_back( sunlight_total.back() + sunlight_of_hour( hour, data.type ) );
+}
+
+void weather_timeline::extend( const int first, const int last )
+{
+    if( hours.empty() ) {
+        first_hour = first;
+    } else if( first < first_hour ) {
+        // Rare, the totals are rebuilt from the new start.
+        std::vector<hour_data> earlier;
+        for( int hour = first; hour < first_hour; hour++ ) {
+            earlier.push_back( compute( hour ) );
+        }
+        hours.insert( hours.begin(), earlier.begin(), earlier.end() );
+        first_hour = first;
+        rot_total.clear();
+        rain_total.clear();
+        acid_total.clear();
+        sunlight_total.clear();
+    }
+    if( rot_total.empty() ) {
+        rot_total.push_back( 0 );
+        rain_total.push_back( 0 );
+        acid_total.push_back( 0 );
+        sunlight_total.push_back( 0.0 );
+        for( size_t i = 0; i < hours.size(); i++ ) {
+            add_totals( hours[i], first_hour + i );
+        }
+    }
+    for( int hour = first_hour + hours.size(); hour <= last; hour++ ) {
+        hours.push_back( compute( hour ) );
+        add_totals( hours.back(), hour );
+    }
+}
+
+int weather_timeline::rot_since( const int startturn, const int endturn ) const
+{
+    const int first = startturn / HOURS( 1 );
+    const int last = endturn / HOURS( 1 );
+    if( first == last ) {
+        return ( endturn - startturn ) * at( first ).rot / HOURS( 1 );
+    }
+    // Partial first and last hours, the ones between are whole.
+    return ( HOURS( first + 1 ) - startturn ) * at( first ).rot / HOURS( 1 ) +
+           ( rot_total[last - first_hour] - rot_total[first + 1 - first_hour] ) +
+           ( endturn - HOURS( last ) ) * at( last ).rot / HOURS( 1 );
+}
+
+weather_sum weather_timeline::sum( const int first, const int last ) const
+{
+    weather_sum data;
+    data.rain_amount = rain_total[last - first_hour] - rain_total[first - first_hour];
+    data.acid_amount = acid_total[last - first_hour] - acid_total[first - first_hour];
+    data.sunlight = sunlight_total[last - first_hour] - sunlight_total[first - first_hour];
+    return data;
+}
+
+} // namespace
+
 int get_rot_since( const int startturn, const int endturn, const tripoint &location )
 {
     // Ensure food doesn't rot in ice labs, where the
@@ -68,6 +338,12 @@ int get_rot_since( const int startturn, const int endturn, const tripoint &locat
     if (is_ot_type("ice_lab", oter)) {
         return 0;
     }
+    // Catching up after a long time uses the shared timeline of the region.
+    if( endturn - startturn > HOURS( 1 ) && startturn >= 0 &&
+        ( endturn - startturn ) / HOURS( 1 ) < max_timeline_hours ) {
+        return timeline_at( location, startturn / HOURS( 1 ),
+                            endturn / HOURS( 1 ) ).rot_since( startturn, endturn );
+    }
     // TODO: maybe have different rotting speed when underground?
     int ret = 0;
     const auto &wgen = g->get_cur_weather_gen();
@@ -113,6 +389,24 @@ weather_sum sum_conditions( const calendar &startturn,
     int tick_size = MINUTES(1);
     weather_sum data;
 
+    // Catching up after more than a week, which used to be sampled hourly, uses the shared
+    // timeline of the region for the whole hours. The partial hours are sampled every minute.
+    if( endturn - startturn > DAYS( 7 ) && startturn.get_turn() >= 0 &&
+        ( endturn - startturn ) / HOURS( 1 ) < max_timeline_hours ) {
+        const int first = ( startturn.get_turn() + HOURS( 1 ) - 1 ) / HOURS( 1 );
+        const int last = endturn.get_turn() / HOURS( 1 );
+        data = timeline_at( location, first, last ).sum( first, last );
+        for( const weather_sum &part : {
+                 sum_conditions( startturn, HOURS( first ), location ),
+                 sum_conditions( HOURS( last ), endturn, location )
+             } ) {
+            data.rain_amount += part.rain_amount;
+            data.acid_amount += part.acid_amount;
+            data.sunlight += part.sunlight;
+        }
+        return data;
+    }
+
     const auto wgen = g->get_cur_weather_gen();
     for( calendar turn(startturn); turn < endturn; turn += tick_size ) {
         const int diff = endturn - startturn;
@@ -141,6 +141,10 @@ int get_local_humidity( double humidity, weather_type weather, bool sheltered =
 int get_local_windpower( double windpower, std::string const &omtername = "no name",
                          bool sheltered = false );
 
+/**
+ * Rain, acid rain and sunlight between the turns, sampled every minute. The whole hours of
+ * intervals longer than a week use the cached hourly weather of the overmap terrain.
+ */
 weather_sum sum_conditions( const calendar &startturn,
                             const calendar &endturn,
                             const tripoint &location );
@@ -164,6 +168,8 @@ double funnel_charges_per_turn( double surface_area_mm2, double rain_depth_mm_pe
  * The location is in absolute maps squares (the system which the @ref map uses),
  * but absolute (@ref map::getabs).
  * The returned value is in turns (at standard conditions it is endturn-startturn).
+ * Intervals longer than an hour use the hourly weather of the overmap terrain, which is
+ * cached, so catching up after a long time is cheap.
  */
 int get_rot_since( int startturn, int endturn, const tripoint &pos );
 
@@ -0,0 +1,54 @@
+#include "catch/catch.hpp"
+
+#include "background_writer.h"
+#include "cata_utility.h"
+#include "filesystem.h"
+
+#include <sstream>
+
+static std::string read_contents( const std::string &path )
+{
+    std::string result;
+    read_from_file( path, [&result]( std::istream & fin ) {
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        result = buffer.str();
+    } );
+    return result;
+}
+
+TEST_CASE( "deferred_writes_are_visible_to_readers" ) {
+    const std::string path = "background_writer_test.txt";
+    remove_file( path );
+
+    {
+        background_writer::deferred_scope deferred;
+        REQUIRE( background_writer::is_deferring() );
+        for( int i = 0; i < 20; ++i ) {
+            CHECK( write_to_file_deferred( path, [i]( std::ostream & fout ) {
+                fout << "version " << i;
+            }, "test data" ) );
+        }
+    }
+    CHECK_FALSE( background_writer::is_deferring() );
+    // Reading waits for the queued writes, and the last one wins.
+    CHECK( read_contents( path ) == "version 19" );
+
+    // A synchronous write must not be overwritten by an older deferred one.
+    {
+        background_writer::deferred_scope deferred;
+        write_to_file_deferred( path, []( std::ostream & fout ) {
+            fout << "deferred";
+        }, "test data" );
+    }
+    write_to_file_deferred( path, []( std::ostream & fout ) {
+        fout << "synchronous";
+    }, "test data" );
+    background_writer::flush();
+    CHECK( background_writer::pending() == 0 );
+    CHECK( read_contents( path ) == "synchronous" );
+    CHECK_FALSE( file_exist( path + ".temp" ) );
+
+    remove_file( path );
+    remove_file( path + ".lock" );
+}
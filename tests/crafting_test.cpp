@@ -2,11 +2,18 @@
 
 #include "crafting.h"
 #include "game.h"
+#include "inventory.h"
 #include "itype.h"
 #include "npc.h"
+#include "overmap.h"
+#include "overmapbuffer.h"
 #include "player.h"
 #include "recipe_dictionary.h"
 
+#include "stdio.h"
+#include <algorithm>
+#include <chrono>
+
 TEST_CASE( "recipe_subset" ) {
     recipe_subset subset;
 
@@ -208,5 +215,101 @@ TEST_CASE( "available_recipes" ) {
                 }
             }
         }
+
+        // The helper lives on the stack, don't leave it behind for the other tests.
+        g->unload_npcs();
+        auto &npcs = overmap_buffer.get( 0, 0 ).npcs;
+        npcs.erase( std::remove( npcs.begin(), npcs.end(), &who ), npcs.end() );
+    }
+}
+
+// Counts the recipes for which the availability differs from checking them directly.
+static int availability_mismatches( recipe_availability &availability, const inventory &inv )
+{
+    int mismatches = 0;
+    for( const auto &r : recipe_dict ) {
+        if( availability.can_make( &r.second, inv ) !=
+            r.second.requirements().can_make_with_inventory( inv ) ) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+TEST_CASE( "recipe_availability_follows_inventory" ) {
+    inventory inv;
+    inv.add_item( item( "hammer" ) );
+    inv.add_item( item( "pot" ) );
+    inv.build_index();
+
+    recipe_availability availability;
+    availability.update( inv, false );
+    CHECK( availability_mismatches( availability, inv ) == 0 );
+    const size_t all_recipes = availability.checks();
+
+    for( int i = 0; i < 10; i++ ) {
+        inv.add_item( item( "rag" ) );
+    }
+    inv.add_item( item( "water_clean" ) );
+    inv.build_index();
+    availability.update( inv, false );
+    CHECK( availability_mismatches( availability, inv ) == 0 );
+    CHECK( availability.checks() > all_recipes );
+    CHECK( availability.checks() < 2 * all_recipes );
+
+    // Without an index everything is checked again.
+    inv.reduce_stack( itype_id( "rag" ), 10 );
+    availability.update( inv, false );
+    CHECK( availability_mismatches( availability, inv ) == 0 );
+}
+
+TEST_CASE( "recipe_availability_benchmark", "[.]" ) {
+    // Knows every recipe and has one of everything the first alternatives need.
+    player dummy;
+    inventory inv;
+    std::set<itype_id> types;
+    for( const auto &r : recipe_dict ) {
+        dummy.learn_recipe( &r.second );
+        const requirement_data &req = r.second.requirements();
+        for( const auto &alternatives : req.get_tools() ) {
+            types.insert( alternatives.front().type );
+        }
+        for( const auto &alternatives : req.get_components() ) {
+            types.insert( alternatives.front().type );
+        }
+    }
+    for( const itype_id &type : types ) {
+        inv.add_item( item( type ) );
     }
+    inv.build_index();
+    const recipe_subset &known = dummy.get_learned_recipes();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    int can_make = 0;
+    for( const recipe *r : known ) {
+        can_make += r->requirements().can_make_with_inventory( inv ) ? 1 : 0;
+    }
+    auto full_end = std::chrono::high_resolution_clock::now();
+
+    recipe_availability availability;
+    availability.update( inv, false );
+    for( const recipe *r : known ) {
+        availability.can_make( r, inv );
+    }
+    const size_t first_checks = availability.checks();
+    // Crafting something uses up a few of the items.
+    inv.reduce_stack( itype_id( "rag" ), 1 );
+    inv.reduce_stack( itype_id( "water_clean" ), 1 );
+    inv.build_index();
+    auto update_start = std::chrono::high_resolution_clock::now();
+    availability.update( inv, false );
+    for( const recipe *r : known ) {
+        availability.can_make( r, inv );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    long full_time = std::chrono::duration_cast<std::chrono::microseconds>( full_end - start ).count();
+    long update_time = std::chrono::duration_cast<std::chrono::microseconds>( end - update_start ).count();
+    printf( "%zu known recipes, %d can be made: checking all %ld microseconds, after a change %ld microseconds (%zu checked again).\n",
+            known.size(), can_make, full_time, update_time, availability.checks() - first_checks );
 }
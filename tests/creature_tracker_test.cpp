@@ -0,0 +1,81 @@
+#include "catch/catch.hpp"
+
+#include "creature_tracker.h"
+#include "game.h"
+#include "map.h"
+#include "monster.h"
+#include "player.h"
+#include "rng.h"
+
+#include "stdio.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+static std::vector<int> brute_force_radius( const tripoint &center, const int radius )
+{
+    std::vector<int> result;
+    for( size_t i = 0; i < g->num_zombies(); i++ ) {
+        const tripoint &p = g->zombie( i ).pos();
+        if( std::abs( p.x - center.x ) <= radius && std::abs( p.y - center.y ) <= radius ) {
+            result.push_back( i );
+        }
+    }
+    return result;
+}
+
+TEST_CASE( "creature_tracker_finds_monsters_in_radius" ) {
+    g->clear_zombies();
+    const int z = g->get_levz();
+    for( int i = 0; i < 60; i++ ) {
+        monster mon( mtype_id( "mon_zombie" ), tripoint( -20 + ( i % 10 ) * 17, -20 + ( i / 10 ) * 29, z ) );
+        g->critter_tracker->add( mon );
+    }
+    // Moves across cells and removals must keep it up to date.
+    g->zombie( 3 ).setpos( g->zombie( 3 ).pos() + tripoint( 30, -25, 0 ) );
+    g->remove_zombie( 5 );
+    g->zombie( 8 ).setpos( g->zombie( 8 ).pos() + tripoint( 1, 1, 0 ) );
+
+    for( const tripoint &center : {
+             tripoint( 60, 60, z ), tripoint( 0, 0, z ), tripoint( -15, 140, z ), g->zombie( 3 ).pos()
+         } ) {
+        for( const int radius : { 0, 1, 11, 12, 40 } ) {
+            CHECK( g->critter_tracker->find_in_radius( center, radius ) ==
+                   brute_force_radius( center, radius ) );
+        }
+    }
+    g->clear_zombies();
+}
+
+TEST_CASE( "monster_plan_benchmark", "[.]" ) {
+    g->clear_zombies();
+    const int z = g->get_levz();
+    const int size = SEEX * MAPSIZE;
+    while( g->num_zombies() < 500 ) {
+        const tripoint p( rng( 0, size - 1 ), rng( 0, size - 1 ), z );
+        if( g->m.passable( p ) && g->mon_at( p ) == -1 && p != g->u.pos() ) {
+            monster mon( mtype_id( "mon_zombie" ), p );
+            g->critter_tracker->add( mon );
+        }
+    }
+    g->m.build_map_cache( z );
+
+    // Same as in game::monmove
+    mfactions factions;
+    for( size_t i = 0; i < g->num_zombies(); i++ ) {
+        factions[g->zombie( i ).faction].insert( i );
+    }
+
+    const int iterations = 10;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int n = 0; n < iterations; n++ ) {
+        for( size_t i = 0; i < g->num_zombies(); i++ ) {
+            g->zombie( i ).plan( factions );
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "monster::plan: %zu monsters planned %d times in %ld microseconds.\n",
+            g->num_zombies(), iterations, diff );
+    g->clear_zombies();
+}
@@ -0,0 +1,77 @@
+#include "catch/catch.hpp"
+
+#include "init.h"
+#include "requirements.h"
+#include "veh_type.h"
+
+#include "stdio.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <vector>
+
+TEST_CASE( "data_loading_benchmark", "[.]" ) {
+    // The data has been loaded when the tests started.
+    const DynamicDataLoader::loading_times &times = DynamicDataLoader::get_instance().get_loading_times();
+    std::vector<std::pair<double, std::string>> types;
+    double loading = 0;
+    for( const auto &e : times.types ) {
+        types.emplace_back( e.second, e.first );
+        loading += e.second;
+    }
+    std::sort( types.rbegin(), types.rend() );
+
+    printf( "Loading data: I/O %.3f seconds, parsing %.3f seconds (both summed over all threads), waiting for files %.3f seconds, loading objects %.3f seconds.\n",
+            times.io, times.parsing, times.waiting, loading );
+    for( size_t i = 0; i < std::min<size_t>( types.size(), 10 ); i++ ) {
+        printf( "  %-20s %.3f seconds\n", types[i].second.c_str(), types[i].first );
+    }
+    printf( "Finalizing %.3f seconds, consistency checks %.3f seconds.\n", times.finalizing,
+            times.checking );
+}
+
+static std::map<vpart_id, std::string> vpart_requirements()
+{
+    const auto print_skills = []( std::ostream & out, const std::map<skill_id, int> &skills ) {
+        for( const auto &e : skills ) {
+            out << e.first.str() << " " << e.second << "\n";
+        }
+    };
+    std::map<vpart_id, std::string> result;
+    for( const auto &e : vpart_info::all() ) {
+        const vpart_info &part = e.second;
+        std::ostringstream out;
+        out << part.install_requirements().list_missing() << part.removal_requirements().list_missing()
+            << part.repair_requirements().list_missing();
+        print_skills( out, part.install_skills );
+        print_skills( out, part.removal_skills );
+        print_skills( out, part.repair_skills );
+        out << part.install_moves << " " << part.removal_moves;
+        result[e.first] = out.str();
+    }
+    return result;
+}
+
+TEST_CASE( "vehicle_part_checks_leave_the_data_alone" ) {
+    // The data has been loaded, finalized and checked when the tests started.
+    for( const auto &e : vpart_info::all() ) {
+        const vpart_info &part = e.second;
+        INFO( e.first.str() );
+        // The finalizing adds the base item to the installation requirements.
+        const requirement_data install = part.install_requirements();
+        const auto &comps = install.get_components();
+        CHECK( std::any_of( comps.begin(), comps.end(), [&part]( const std::vector<item_comp> &alt ) {
+            return alt.size() == 1 && alt.front().type == part.item;
+        } ) );
+        CHECK( part.removal_moves >= 0 );
+    }
+
+    const auto before = vpart_requirements();
+    vpart_info::check();
+    const auto after = vpart_requirements();
+    REQUIRE( after.size() == before.size() );
+    for( const auto &e : before ) {
+        INFO( e.first.str() );
+        CHECK( after.at( e.first ) == e.second );
+    }
+}
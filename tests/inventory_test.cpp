@@ -0,0 +1,138 @@
+#include "catch/catch.hpp"
+
+#include "crafting.h"
+#include "game.h"
+#include "inventory.h"
+#include "item.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+#include "player.h"
+#include "recipe_dictionary.h"
+#include "requirements.h"
+#include "vehicle.h"
+
+static inventory workshop()
+{
+    inventory inv;
+    inv.add_item( item( "hammer" ) );
+    inv.add_item( item( "screwdriver_set" ) );
+    inv.add_item( item( "pot" ) );
+    for( int i = 0; i < 5; i++ ) {
+        inv.add_item( item( "rag" ) );
+    }
+    item bottle( "bottle_plastic" );
+    bottle.put_in( item( "water_clean" ) );
+    inv.add_item( bottle );
+    item soldering_iron( "soldering_iron" );
+    soldering_iron.ammo_set( "battery", 50 );
+    inv.add_item( soldering_iron );
+    item hotplate( "hotplate" );
+    hotplate.ammo_set( "battery", 20 );
+    inv.add_item( hotplate );
+    // Loose batteries, the charges of the tools above are not counted.
+    inv.add_item( item( "battery", 0, 30 ) );
+    // Content of guns is not visited.
+    item gun( "glock_19" );
+    item mag( "glockmag" );
+    mag.ammo_set( "9mm", 10 );
+    gun.contents.push_back( mag );
+    inv.add_item( gun );
+    item fire( "fire", 0 );
+    fire.charges = 1;
+    fire.item_tags.insert( "PSEUDO" );
+    inv.add_item( fire );
+    return inv;
+}
+
+static int requirement_mismatches( const inventory &indexed, const inventory &visited )
+{
+    int mismatches = 0;
+    for( const auto &r : recipe_dict ) {
+        const requirement_data &req = r.second.requirements();
+        for( const int batch : { 1, 4 } ) {
+            for( const auto &alternatives : req.get_tools() ) {
+                for( const tool_comp &tool : alternatives ) {
+                    mismatches += tool.has( indexed, batch ) != tool.has( visited, batch );
+                }
+            }
+            for( const auto &alternatives : req.get_components() ) {
+                for( const item_comp &comp : alternatives ) {
+                    mismatches += comp.has( indexed, batch ) != comp.has( visited, batch );
+                }
+            }
+            for( const auto &alternatives : req.get_qualities() ) {
+                for( const quality_requirement &qual : alternatives ) {
+                    mismatches += qual.has( indexed, batch ) != qual.has( visited, batch );
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+TEST_CASE( "inventory_index_matches_visiting_items" ) {
+    const inventory visited = workshop();
+    inventory indexed = workshop();
+    indexed.build_index();
+
+    REQUIRE( recipe_dict.size() > 0 );
+    CHECK( requirement_mismatches( indexed, visited ) == 0 );
+
+    CHECK( indexed.has_tools( "fire", 1 ) );
+    CHECK_FALSE( indexed.has_components( "fire", 1 ) );
+    CHECK( indexed.has_components( "rag", 5 ) );
+    CHECK( visited.charges_of( "battery" ) > 0 );
+    CHECK( indexed.has_charges( "battery", visited.charges_of( "battery" ) ) );
+    CHECK_FALSE( indexed.has_charges( "battery", visited.charges_of( "battery" ) + 1 ) );
+    CHECK_FALSE( indexed.has_charges( "9mm", 1 ) );
+
+    // Removing items drops the index.
+    indexed.reduce_stack( itype_id( "rag" ), 2 );
+    CHECK( indexed.has_components( "rag", 3 ) );
+    CHECK_FALSE( indexed.has_components( "rag", 4 ) );
+}
+
+TEST_CASE( "nearby_items_are_counted_without_copying_them" ) {
+    const tripoint origin = g->u.pos();
+    for( const tripoint &p : g->m.points_in_radius( origin, 1 ) ) {
+        while( vehicle *veh = g->m.veh_at( p ) ) {
+            g->m.destroy_vehicle( veh );
+        }
+        g->m.i_clear( p );
+        g->m.ter_set( p, t_floor );
+        g->m.furn_set( p, f_null );
+    }
+    const inventory items = workshop();
+    for( const auto &stack : items.const_slice() ) {
+        for( const item &it : *stack ) {
+            if( !it.has_flag( "PSEUDO" ) ) {
+                g->m.add_item( origin, it );
+            }
+        }
+    }
+    g->m.add_item( origin, item( "textbook_chemistry" ) );
+
+    inventory copied;
+    copied.form_from_map( origin, 1 );
+    inventory counted;
+    counted.form_index_from_map( origin, 1 );
+
+    CHECK( copied.size() > 0 );
+    CHECK( counted.size() == 0 );
+    CHECK( requirement_mismatches( counted, copied ) == 0 );
+    for( const itype_id &type : { "rag", "battery", "water_clean", "soldering_iron" } ) {
+        CHECK( counted.amount_of( type ) == copied.amount_of( type ) );
+        CHECK( counted.charges_of( type ) == copied.charges_of( type ) );
+    }
+    REQUIRE( counted.get_index() );
+    CHECK( counted.get_index()->books == std::set<itype_id>( { "textbook_chemistry" } ) );
+
+    // Added items are counted next to the nearby ones.
+    counted += item( "rag" );
+    CHECK( counted.amount_of( "rag" ) == copied.amount_of( "rag" ) + 1 );
+
+    for( const tripoint &p : g->m.points_in_radius( origin, 1 ) ) {
+        g->m.i_clear( p );
+    }
+}
@@ -0,0 +1,76 @@
+#include "catch/catch.hpp"
+
+#include "flag.h"
+#include "item.h"
+#include "item_factory.h"
+#include "itype.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_CASE( "item_flags_match_type_and_item_tags" ) {
+    for( const auto &e : item_controller->get_all_itypes() ) {
+        const itype *type = e.second.get();
+        if( type->mod ) {
+            // Attached mods would be checked as well.
+            continue;
+        }
+        const item it( type );
+        for( const std::string &f : type->item_tags ) {
+            CHECK( it.has_flag( f ) );
+            CHECK( it.has_flag( flag_set::id( f ) ) );
+        }
+    }
+
+    item hammer( "hammer" );
+    CHECK_FALSE( hammer.has_flag( "NOT_A_FLAG_ANYWHERE" ) );
+    CHECK_FALSE( hammer.has_flag( "FIT" ) );
+    hammer.item_tags.insert( "FIT" );
+    CHECK( hammer.has_flag( "FIT" ) );
+    CHECK( hammer.has_flag( flag_set::id( "FIT" ) ) );
+    CHECK( flag_set::name( flag_set::id( "FIT" ) ) == "FIT" );
+}
+
+TEST_CASE( "item_flags_benchmark", "[.]" ) {
+    const item it( "glock_19" );
+    const std::vector<std::string> flags = { "FIT", "VARSIZE", "RELOAD_ONE", "NEVER_JAMS", "PSEUDO", "LIGHT_8", "WATERPROOF_GUN", "NO_UNLOAD" };
+    std::vector<int> ids;
+    for( const std::string &f : flags ) {
+        ids.push_back( flag_set::id( f ) );
+    }
+    const int iterations = 100000;
+    int found = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const std::string &f : flags ) {
+            // The lookups has_flag used to do, without the attached mods.
+            if( json_flag::get( f ).inherit() && it.type->item_tags.count( f ) ) {
+                found++;
+            } else if( it.item_tags.count( f ) ) {
+                found++;
+            }
+        }
+    }
+    auto strings_end = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const std::string &f : flags ) {
+            found += it.has_flag( f );
+        }
+    }
+    auto wrapper_end = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const int f : ids ) {
+            found += it.has_flag( f );
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    long strings_time = std::chrono::duration_cast<std::chrono::microseconds>( strings_end - start ).count();
+    long wrapper_time = std::chrono::duration_cast<std::chrono::microseconds>( wrapper_end - strings_end ).count();
+    long ids_time = std::chrono::duration_cast<std::chrono::microseconds>( end - wrapper_end ).count();
+    printf( "item::has_flag, %d checks: string sets %ld microseconds, by name %ld microseconds, by interned id %ld microseconds (%d found).\n",
+            iterations * static_cast<int>( flags.size() ), strings_time, wrapper_time, ids_time, found );
+}
@@ -0,0 +1,133 @@
+#include "catch/catch.hpp"
+
+#include "filesystem.h"
+#include "item.h"
+#include "json.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE( "json_object_members" ) {
+    const std::string data =
+        "{ \"name\": \"a \\\"quoted\\\" \\u00e4 string\\nwith a newline\", \"count\": -12,"
+        "  \"//\": \"first comment\", \"nested\": { \"list\": [ 1, 2.5e1, true ] }, \"//\": \"second\" }";
+    JsonIn jsin( data.data(), data.size() );
+    JsonObject jo = jsin.get_object();
+
+    CHECK( jo.get_string( "name" ) == "a \"quoted\" \xc3\xa4 string\nwith a newline" );
+    CHECK( jo.get_int( "count" ) == -12 );
+    CHECK( jo.get_string( "//" ) == "second" );
+    CHECK( jo.get_int( "missing", 7 ) == 7 );
+    CHECK_FALSE( jo.has_member( "missing" ) );
+    // Looking up missing members does not add them.
+    CHECK( jo.get_member_names() == std::set<std::string>( { "name", "count", "//", "nested" } ) );
+
+    JsonArray list = jo.get_object( "nested" ).get_array( "list" );
+    CHECK( list.next_int() == 1 );
+    CHECK( list.next_float() == 25.0 );
+    CHECK( list.next_bool() );
+    CHECK_FALSE( list.has_more() );
+}
+
+TEST_CASE( "json_errors_point_to_the_problem" ) {
+    const std::string data = "[\n  { \"a\": 1 },\n  { \"a\": 1, \"a\": 2 }\n]";
+    std::istringstream stream( data );
+    JsonIn jsin( stream );
+    jsin.start_array();
+    jsin.get_object();
+    try {
+        jsin.get_object();
+        FAIL( "duplicate member was not detected" );
+    } catch( const JsonError &err ) {
+        CHECK( std::string( err.what() ).find( "line 3:" ) == 0 );
+        CHECK( std::string( err.what() ).find( "duplicate entry in json object" ) != std::string::npos );
+    }
+}
+
+TEST_CASE( "json_in_leaves_the_stream_after_the_value" ) {
+    std::istringstream stream( "# header\n{ \"first\": 1 } [ 2 ]" );
+    std::string header;
+    std::getline( stream, header );
+    {
+        // Not strict, two values in a row are not valid JSON.
+        JsonIn jsin( stream, false );
+        CHECK( jsin.get_object().get_int( "first" ) == 1 );
+    }
+    {
+        JsonIn jsin( stream );
+        jsin.start_array();
+        CHECK( jsin.get_int() == 2 );
+        CHECK( jsin.end_array() );
+    }
+}
+
+// Visits every value, like the loaders do.
+static size_t walk( JsonIn &jsin )
+{
+    size_t values = 1;
+    if( jsin.test_object() ) {
+        JsonObject jo = jsin.get_object();
+        for( const std::string &name : jo.get_member_names() ) {
+            values += walk( *jo.get_raw( name ) );
+        }
+    } else if( jsin.test_array() ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            values += walk( jsin );
+        }
+    } else if( jsin.test_string() ) {
+        jsin.get_string();
+    } else {
+        jsin.skip_value();
+    }
+    return values;
+}
+
+TEST_CASE( "json_parsing_benchmark", "[.]" ) {
+    std::vector<std::string> files;
+    for( const std::string &path : get_files_from_path( ".json", "data/json", true, true ) ) {
+        std::ifstream fin( path.c_str(), std::ifstream::binary );
+        files.emplace_back( ( std::istreambuf_iterator<char>( fin ) ), std::istreambuf_iterator<char>() );
+    }
+    size_t bytes = 0;
+    size_t values = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( const std::string &contents : files ) {
+        JsonIn jsin( contents.data(), contents.size() );
+        values += walk( jsin );
+        bytes += contents.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>( end - start ).count();
+    printf( "data/json: %zu files, %zu bytes, %zu values in %.3f seconds (%.1f MB/s).\n",
+            files.size(), bytes, values, seconds, bytes / seconds / 1e6 );
+
+    // Something like the items of a large base in a save file.
+    std::ostringstream save;
+    {
+        JsonOut jsout( save );
+        jsout.start_array();
+        for( int i = 0; i < 5000; i++ ) {
+            item bottle( "bottle_plastic" );
+            bottle.put_in( item( "water_clean" ) );
+            jsout.write( bottle );
+            jsout.write( item( "hammer" ) );
+            jsout.write( item( "glock_19" ) );
+            jsout.write( item( "rag" ) );
+        }
+        jsout.end_array();
+    }
+    const std::string contents = save.str();
+    start = std::chrono::high_resolution_clock::now();
+    JsonIn jsin( contents.data(), contents.size() );
+    std::vector<item> items;
+    jsin.read( items );
+    end = std::chrono::high_resolution_clock::now();
+    seconds = std::chrono::duration<double>( end - start ).count();
+    printf( "Save data: %zu items, %zu bytes in %.3f seconds (%.1f MB/s).\n",
+            items.size(), contents.size(), seconds, contents.size() / seconds / 1e6 );
+}
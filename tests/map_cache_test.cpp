@@ -0,0 +1,303 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "item.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+
+#include "stdio.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+struct cache_snapshot {
+    bool outside_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    bool floor_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    float transparency_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+};
+
+static void take_snapshot( cache_snapshot &snapshot, const int z )
+{
+    const level_cache &ch = g->m.get_cache_ref( z );
+    memcpy( snapshot.outside_cache, ch.outside_cache, sizeof( ch.outside_cache ) );
+    memcpy( snapshot.floor_cache, ch.floor_cache, sizeof( ch.floor_cache ) );
+    memcpy( snapshot.transparency_cache, ch.transparency_cache, sizeof( ch.transparency_cache ) );
+}
+
+static void set_all_dirty( const int z )
+{
+    g->m.set_transparency_cache_dirty( z );
+    g->m.set_outside_cache_dirty( z );
+    g->m.set_floor_cache_dirty( z );
+}
+
+TEST_CASE( "incremental_map_cache_matches_full_rebuild" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    // On the corner of four submaps, so the outside cache of all of them changes.
+    const tripoint corner( SEEX * 4 - 1, SEEY * 4 - 1, z );
+    const tripoint middle( SEEX * 5 + 3, SEEY * 6 + 7, z );
+    const ter_id old_corner = m.ter( corner );
+    const ter_id old_middle = m.ter( middle );
+
+    set_all_dirty( z );
+    m.build_map_cache( z, true );
+
+    cache_snapshot *incremental = new cache_snapshot();
+    cache_snapshot *full = new cache_snapshot();
+    for( const ter_id &ter : { ter_id( "t_floor" ), ter_id( "t_wall" ), ter_id( "t_grass" ) } ) {
+        m.ter_set( corner, ter );
+        m.ter_set( middle, ter );
+        m.build_map_cache( z, true );
+        take_snapshot( *incremental, z );
+
+        set_all_dirty( z );
+        m.build_map_cache( z, true );
+        take_snapshot( *full, z );
+
+        CHECK( memcmp( incremental->outside_cache, full->outside_cache,
+                       sizeof( full->outside_cache ) ) == 0 );
+        CHECK( memcmp( incremental->floor_cache, full->floor_cache, sizeof( full->floor_cache ) ) == 0 );
+        CHECK( memcmp( incremental->transparency_cache, full->transparency_cache,
+                       sizeof( full->transparency_cache ) ) == 0 );
+    }
+    delete incremental;
+    delete full;
+
+    m.ter_set( corner, old_corner );
+    m.ter_set( middle, old_middle );
+}
+
+TEST_CASE( "spreading_fields_mark_the_submaps_they_reach" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    // Smoke on the edge of a submap spreads into the next one.
+    const tripoint edge( SEEX * 5 - 1, SEEY * 5 + 5, z );
+    std::vector<std::pair<tripoint, ter_id>> old_ter;
+    for( const tripoint &p : m.points_in_radius( edge, 12 ) ) {
+        old_ter.emplace_back( p, m.ter( p ) );
+        m.ter_set( p, ter_id( "t_floor" ) );
+    }
+
+    cache_snapshot *incremental = new cache_snapshot();
+    cache_snapshot *full = new cache_snapshot();
+    for( int i = 0; i < 10; i++ ) {
+        m.add_field( edge, fd_smoke, 3, 0 );
+        set_all_dirty( z );
+        m.build_map_cache( z, true );
+
+        m.process_fields();
+        m.build_map_cache( z, true );
+        take_snapshot( *incremental, z );
+
+        set_all_dirty( z );
+        m.build_map_cache( z, true );
+        take_snapshot( *full, z );
+        CHECK( memcmp( incremental->transparency_cache, full->transparency_cache,
+                       sizeof( full->transparency_cache ) ) == 0 );
+    }
+    delete incremental;
+    delete full;
+
+    for( const auto &e : old_ter ) {
+        m.remove_field( e.first, fd_smoke );
+        m.ter_set( e.first, e.second );
+    }
+    m.build_map_cache( z, true );
+}
+
+TEST_CASE( "line_of_sight_cache_follows_map_cache" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    const tripoint from( SEEX * 5, SEEY * 5, z );
+    const tripoint to( SEEX * 5 + 6, SEEY * 5 + 2, z );
+    const tripoint between( SEEX * 5 + 3, SEEY * 5 + 1, z );
+    std::vector<ter_id> old_ter;
+    for( int x = from.x; x <= to.x; x++ ) {
+        for( int y = from.y; y <= to.y; y++ ) {
+            old_ter.push_back( m.ter( tripoint( x, y, z ) ) );
+            m.ter_set( tripoint( x, y, z ), ter_id( "t_floor" ) );
+        }
+    }
+    m.build_map_cache( z, true );
+
+    const long hits = m.get_los_cache_stats().hits;
+    CHECK( m.sees( from, to, -1 ) );
+    CHECK( m.sees( from, to, 60 ) );
+    CHECK_FALSE( m.sees( from, to, 3 ) );
+    CHECK( m.get_los_cache_stats().hits == hits + 1 );
+
+    m.ter_set( between, ter_id( "t_wall" ) );
+    m.build_map_cache( z, true );
+    CHECK_FALSE( m.sees( from, to, -1 ) );
+
+    size_t i = 0;
+    for( int x = from.x; x <= to.x; x++ ) {
+        for( int y = from.y; y <= to.y; y++ ) {
+            m.ter_set( tripoint( x, y, z ), old_ter[i++] );
+        }
+    }
+    m.build_map_cache( z, true );
+}
+
+TEST_CASE( "map_cache_benchmark", "[.]" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    const tripoint p( SEEX * 5 + 3, SEEY * 6 + 7, z );
+    const ter_id old_ter = m.ter( p );
+    const int iterations = 1000;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        set_all_dirty( z );
+        m.build_map_cache( z, true );
+    }
+    auto full_end = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        // Changes transparency and outside cache.
+        m.ter_set( p, i % 2 == 0 ? ter_id( "t_wall" ) : ter_id( "t_grass" ) );
+        m.build_map_cache( z, true );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    m.ter_set( p, old_ter );
+
+    long full_time = std::chrono::duration_cast<std::chrono::microseconds>( full_end - start ).count();
+    long single_time = std::chrono::duration_cast<std::chrono::microseconds>( end - full_end ).count();
+    printf( "build_map_cache: full rebuild %ld microseconds, after a single tile change %ld microseconds (%d iterations).\n",
+            full_time, single_time, iterations );
+}
+
+struct lightmap_snapshot {
+    float lm[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    float sm[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    // Only used in daylight, so compared separately.
+    std::vector<std::pair<point, int>> sunlight_openings[MAPSIZE * MAPSIZE];
+};
+
+static void take_snapshot( lightmap_snapshot &snapshot, const int z )
+{
+    const level_cache &ch = g->m.get_cache_ref( z );
+    memcpy( snapshot.lm, ch.lm, sizeof( ch.lm ) );
+    memcpy( snapshot.sm, ch.sm, sizeof( ch.sm ) );
+    std::copy( std::begin( ch.sunlight_openings ), std::end( ch.sunlight_openings ),
+               std::begin( snapshot.sunlight_openings ) );
+}
+
+// What generate_lightmap did before it kept the light sources of the submaps: look at every tile.
+static void set_all_light_sources_dirty( const int z )
+{
+    for( int smx = 0; smx < MAPSIZE; smx++ ) {
+        for( int smy = 0; smy < MAPSIZE; smy++ ) {
+            g->m.set_light_source_dirty( tripoint( smx * SEEX, smy * SEEY, z ) );
+        }
+    }
+}
+
+static void check_lightmap_matches_full_rebuild( const int z )
+{
+    lightmap_snapshot *incremental = new lightmap_snapshot();
+    lightmap_snapshot *full = new lightmap_snapshot();
+    g->m.build_map_cache( z );
+    take_snapshot( *incremental, z );
+    set_all_dirty( z );
+    set_all_light_sources_dirty( z );
+    g->m.build_map_cache( z );
+    take_snapshot( *full, z );
+    CHECK( memcmp( incremental->lm, full->lm, sizeof( full->lm ) ) == 0 );
+    CHECK( memcmp( incremental->sm, full->sm, sizeof( full->sm ) ) == 0 );
+    for( int i = 0; i < MAPSIZE * MAPSIZE; i++ ) {
+        INFO( "submap " << i );
+        CHECK( incremental->sunlight_openings[i] == full->sunlight_openings[i] );
+    }
+    delete incremental;
+    delete full;
+}
+
+TEST_CASE( "incremental_light_sources_match_full_rebuild" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    const tripoint lamp( SEEX * 3 + 2, SEEY * 3 + 2, z );
+    const tripoint fire( SEEX * 7 + 5, SEEY * 3 + 11, z );
+    const tripoint lantern( SEEX * 4 - 1, SEEY * 8, z );
+    const ter_id old_lamp = m.ter( lamp );
+    const ter_id old_fire = m.ter( fire );
+    const ter_id old_lantern = m.ter( lantern );
+    m.ter_set( lantern, ter_id( "t_dirt" ) );
+    m.i_clear( lantern );
+    check_lightmap_matches_full_rebuild( z );
+
+    m.ter_set( lamp, ter_id( "t_utility_light" ) );
+    m.ter_set( fire, ter_id( "t_dirt" ) );
+    m.add_field( fire, fd_fire, 3, 0 );
+    m.add_item( lantern, item( "atomic_lamp" ) );
+    check_lightmap_matches_full_rebuild( z );
+    CHECK( m.get_cache_ref( z ).sm[lamp.x][lamp.y] >= 240 );
+    CHECK( m.get_cache_ref( z ).sm[fire.x][fire.y] >= 160 );
+    CHECK( m.get_cache_ref( z ).sm[lantern.x][lantern.y] > 0 );
+
+    m.ter_set( lamp, old_lamp );
+    m.remove_field( fire, fd_fire );
+    m.ter_set( fire, old_fire );
+    m.i_clear( lantern );
+    m.ter_set( lantern, old_lantern );
+    check_lightmap_matches_full_rebuild( z );
+
+    // An indoors tile next to the edge of a submap changes the openings of its neighbor:
+    // the last tile of the left submap has sunlight coming in from the right until the
+    // first tile of the right submap is indoors as well.
+    const tripoint edge( SEEX * 5 - 1, SEEY * 5, z );
+    std::vector<std::pair<tripoint, ter_id>> old_ter;
+    for( const tripoint &p : m.points_in_radius( edge, 3 ) ) {
+        old_ter.emplace_back( p, m.ter( p ) );
+        m.ter_set( p, ter_id( "t_dirt" ) );
+    }
+    m.ter_set( edge + tripoint( -1, 0, 0 ), ter_id( "t_floor" ) );
+    check_lightmap_matches_full_rebuild( z );
+    m.ter_set( edge + tripoint( 2, 0, 0 ), ter_id( "t_floor" ) );
+    check_lightmap_matches_full_rebuild( z );
+    for( const auto &e : old_ter ) {
+        m.ter_set( e.first, e.second );
+    }
+    check_lightmap_matches_full_rebuild( z );
+}
+
+TEST_CASE( "burning_city_block_lightmap_benchmark", "[.]" ) {
+    map &m = g->m;
+    const int z = g->get_levz();
+    // Two by two submaps on fire.
+    std::vector<std::pair<tripoint, ter_id>> old_ter;
+    for( const tripoint &p : m.points_in_rectangle( tripoint( SEEX * 6, SEEY * 6, z ),
+            tripoint( SEEX * 8 - 1, SEEY * 8 - 1, z ) ) ) {
+        old_ter.emplace_back( p, m.ter( p ) );
+        m.ter_set( p, ter_id( "t_dirt" ) );
+        m.add_field( p, fd_fire, 3, 0 );
+    }
+    const int iterations = 100;
+    m.build_map_cache( z );
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        set_all_light_sources_dirty( z );
+        m.build_map_cache( z );
+    }
+    auto full_end = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        m.build_map_cache( z );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    for( const auto &e : old_ter ) {
+        m.remove_field( e.first, fd_fire );
+        m.ter_set( e.first, e.second );
+    }
+    m.build_map_cache( z );
+
+    long full_time = std::chrono::duration_cast<std::chrono::microseconds>( full_end - start ).count();
+    long kept_time = std::chrono::duration_cast<std::chrono::microseconds>( end - full_end ).count();
+    printf( "build_map_cache with a burning city block: every tile looked at %ld microseconds, kept light sources %ld microseconds (%d iterations).\n",
+            full_time, kept_time, iterations );
+}
@@ -0,0 +1,108 @@
+#include "catch/catch.hpp"
+
+#include "enums.h"
+#include "field.h"
+#include "item.h"
+#include "mapbuffer.h"
+#include "mapdata.h"
+#include "rng.h"
+#include "submap.h"
+#include "trap.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <sstream>
+
+// Fills the quad at the given overmap terrain position with some of everything.
+static std::vector<tripoint> fill_quad( mapbuffer &buffer, const int x, const int y )
+{
+    std::vector<tripoint> addrs;
+    for( int offset = 0; offset < 4; offset++ ) {
+        const tripoint addr( x * 2 + offset % 2, y * 2 + offset / 2, 0 );
+        submap *sm = new submap();
+        sm->turn_last_touched = 1000 + offset;
+        sm->temperature = 65 - offset;
+        for( int j = 0; j < SEEY; j++ ) {
+            for( int i = 0; i < SEEX; i++ ) {
+                sm->set_ter( i, j, one_in( 4 ) ? ter_id( "t_grass" ) : ter_id( "t_dirt" ) );
+                if( one_in( 10 ) ) {
+                    sm->set_furn( i, j, furn_id( "f_rubble" ) );
+                }
+            }
+        }
+        sm->set_radiation( 1, 2, 15 );
+        sm->set_trap( 3, 4, trap_str_id( "tr_bubblewrap" ).id() );
+        sm->itm[5][6].push_back( item( "rock", 0 ) );
+        sm->itm[5][6].push_back( item( "water_clean", 0 ) );
+        sm->fld[7][8].addField( fd_blood, 2, 30 );
+        sm->field_count++;
+        sm->cosmetics[9][10]["SIGNAGE"] = "Keep out";
+        sm->spawns.push_back( spawn_point( mtype_id( "mon_zombie" ), 2, 11, 1, -1, -1, false, "" ) );
+        buffer.add_submap( addr, sm );
+        addrs.push_back( addr );
+    }
+    return addrs;
+}
+
+static std::string write_quad( mapbuffer &buffer, const std::vector<tripoint> &addrs,
+                               const bool binary )
+{
+    std::ostringstream out;
+    buffer.write_quad( out, addrs, binary );
+    return out.str();
+}
+
+TEST_CASE( "binary_quads_round_trip_losslessly" ) {
+    mapbuffer original;
+    const std::vector<tripoint> addrs = fill_quad( original, 0, 0 );
+    const std::string json = write_quad( original, addrs, false );
+
+    mapbuffer from_json;
+    std::istringstream json_in( json );
+    from_json.read_quad( json_in, false );
+    const std::string binary = write_quad( from_json, addrs, true );
+    CHECK( binary.size() < json.size() );
+
+    // Reading the JSON transposes the radiation, compare with what the binary was written from.
+    const std::string reference = write_quad( from_json, addrs, false );
+    mapbuffer from_binary;
+    std::istringstream binary_in( binary );
+    from_binary.read_quad( binary_in, true );
+    CHECK( write_quad( from_binary, addrs, false ) == reference );
+
+    // Truncated files must be rejected, not half loaded.
+    mapbuffer truncated;
+    std::istringstream truncated_in( binary.substr( 0, binary.size() / 2 ) );
+    CHECK_THROWS( truncated.read_quad( truncated_in, true ) );
+}
+
+TEST_CASE( "map_format_benchmark", "[.]" ) {
+    const int quads = 1000;
+    for( const bool binary : { false, true } ) {
+        mapbuffer buffer;
+        std::vector<std::vector<tripoint>> quad_addrs;
+        for( int n = 0; n < quads; n++ ) {
+            quad_addrs.push_back( fill_quad( buffer, n % 32, n / 32 ) );
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::string> files;
+        size_t total_size = 0;
+        for( const auto &addrs : quad_addrs ) {
+            files.push_back( write_quad( buffer, addrs, binary ) );
+            total_size += files.back().size();
+        }
+        auto saved = std::chrono::high_resolution_clock::now();
+        mapbuffer loaded;
+        for( const std::string &file : files ) {
+            std::istringstream in( file );
+            loaded.read_quad( in, binary );
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        long save_time = std::chrono::duration_cast<std::chrono::microseconds>( saved - start ).count();
+        long load_time = std::chrono::duration_cast<std::chrono::microseconds>( end - saved ).count();
+        printf( "%s: %d quads saved in %ld microseconds, loaded in %ld microseconds, %zu bytes.\n",
+                binary ? "binary" : "JSON", quads, save_time, load_time, total_size );
+    }
+}
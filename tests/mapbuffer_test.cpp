@@ -0,0 +1,68 @@
+#include "catch/catch.hpp"
+
+#include "coordinate_conversions.h"
+#include "mapbuffer.h"
+#include "mapdata.h"
+#include "submap.h"
+#include "vehicle.h"
+
+// Far away from the reality bubble of the test game.
+static const tripoint origin( 1000, 1000, 0 );
+
+static void add_uniform_quad( mapbuffer &buffer, const tripoint &om_addr )
+{
+    const tripoint first = omt_to_sm_copy( origin + om_addr );
+    for( int x = 0; x < 2; x++ ) {
+        for( int y = 0; y < 2; y++ ) {
+            submap *sm = new submap();
+            sm->is_uniform = true;
+            for( int j = 0; j < SEEY; j++ ) {
+                for( int i = 0; i < SEEX; i++ ) {
+                    sm->set_ter( i, j, t_rock );
+                }
+            }
+            buffer.add_submap( first + point( x, y ), sm );
+        }
+    }
+}
+
+TEST_CASE( "mapbuffer_evicts_least_recently_used_quads" ) {
+    mapbuffer buffer;
+    add_uniform_quad( buffer, tripoint( 0, 0, 0 ) );
+    add_uniform_quad( buffer, tripoint( 1, 0, 0 ) );
+    add_uniform_quad( buffer, tripoint( 2, 0, 0 ) );
+    REQUIRE( buffer.size() == 12 );
+
+    // Now the second quad is the least recently used one.
+    const tripoint first_quad = omt_to_sm_copy( origin );
+    REQUIRE( buffer.lookup_submap( first_quad ) != nullptr );
+
+    CHECK( buffer.evict_unused( 12 ) == 0 );
+    // Uniform quads are not saved, so nothing is written here.
+    CHECK( buffer.evict_unused( 8 ) == 4 );
+    CHECK( buffer.size() == 8 );
+    CHECK( buffer.lookup_submap( first_quad ) != nullptr );
+    CHECK( buffer.lookup_submap( omt_to_sm_copy( origin + tripoint( 2, 0, 0 ) ) ) != nullptr );
+    CHECK( buffer.lookup_submap( omt_to_sm_copy( origin + tripoint( 1, 0, 0 ) ) ) == nullptr );
+}
+
+TEST_CASE( "parked_vehicles_outside_the_bubble_cost_nothing" ) {
+    mapbuffer buffer;
+    const int parked = 2000;
+    for( int n = 0; n <= parked; n++ ) {
+        submap *sm = new submap();
+        // The last one gets a charged battery and draws power from it every turn.
+        vehicle *veh = new vehicle( vproto_id( "car" ), n == parked ? 100 : 0, 0 );
+        veh->camera_on = n == parked;
+        sm->vehicles.push_back( veh );
+        buffer.add_submap( omt_to_sm_copy( origin ) + point( n % 100, n / 100 ), sm );
+    }
+
+    // Only the vehicle that needs upkeep is processed, however many are parked.
+    CHECK( buffer.process_vehicles_outside_bubble() == 1 );
+    CHECK( buffer.process_vehicles_outside_bubble() == 1 );
+
+    buffer.lookup_submap( omt_to_sm_copy( origin ) + point( parked % 100, parked / 100 ) )
+    ->vehicles.front()->camera_on = false;
+    CHECK( buffer.process_vehicles_outside_bubble() == 0 );
+}
@@ -0,0 +1,197 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "mapdata.h"
+#include "pathfinding.h"
+#include "rng.h"
+
+#include "stdio.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Remembers terrain and furniture of the whole map and puts it back afterwards.
+class map_restorer
+{
+    public:
+        map_restorer( const int z ) : z( z ) {
+            for( int x = 0; x < SEEX * MAPSIZE; x++ ) {
+                for( int y = 0; y < SEEY * MAPSIZE; y++ ) {
+                    ter.push_back( g->m.ter( tripoint( x, y, z ) ) );
+                    furn.push_back( g->m.furn( tripoint( x, y, z ) ) );
+                }
+            }
+        }
+        ~map_restorer() {
+            size_t i = 0;
+            for( int x = 0; x < SEEX * MAPSIZE; x++ ) {
+                for( int y = 0; y < SEEY * MAPSIZE; y++ ) {
+                    g->m.ter_set( tripoint( x, y, z ), ter[i] );
+                    g->m.furn_set( tripoint( x, y, z ), furn[i] );
+                    i++;
+                }
+            }
+        }
+
+    private:
+        int z;
+        std::vector<ter_id> ter;
+        std::vector<furn_id> furn;
+};
+
+static void clear_area( const tripoint &from, const tripoint &to )
+{
+    for( int x = from.x; x <= to.x; x++ ) {
+        for( int y = from.y; y <= to.y; y++ ) {
+            // The test world is random, it may have parked a car here.
+            while( vehicle *veh = g->m.veh_at( tripoint( x, y, from.z ) ) ) {
+                g->m.destroy_vehicle( veh );
+            }
+            g->m.ter_set( tripoint( x, y, from.z ), t_floor );
+            g->m.furn_set( tripoint( x, y, from.z ), f_null );
+        }
+    }
+}
+
+static void check_path( const std::vector<tripoint> &path, const tripoint &from, const tripoint &to )
+{
+    REQUIRE_FALSE( path.empty() );
+    CHECK( path.back() == to );
+    tripoint prev = from;
+    for( const tripoint &p : path ) {
+        CHECK( square_dist( prev, p ) == 1 );
+        CHECK( g->m.passable( p ) );
+        prev = p;
+    }
+}
+
+TEST_CASE( "route_goes_around_walls" ) {
+    const int z = g->get_levz();
+    map_restorer restorer( z );
+    const tripoint corner( SEEX * 4, SEEY * 4, z );
+    // Low enough for the gap to be in the area map::route searches around the end points.
+    clear_area( corner, corner + tripoint( 20, 16, 0 ) );
+    for( int i = 0; i <= 20; i++ ) {
+        g->m.ter_set( corner + tripoint( i, 0, 0 ), t_wall );
+        g->m.ter_set( corner + tripoint( i, 16, 0 ), t_wall );
+    }
+    for( int i = 0; i <= 16; i++ ) {
+        g->m.ter_set( corner + tripoint( 0, i, 0 ), t_wall );
+        g->m.ter_set( corner + tripoint( 20, i, 0 ), t_wall );
+    }
+    // A wall through the room with a single gap at its lower end.
+    for( int y = 1; y < 15; y++ ) {
+        g->m.ter_set( corner + tripoint( 10, y, 0 ), t_wall );
+    }
+
+    const tripoint from = corner + tripoint( 5, 2, 0 );
+    const tripoint to = corner + tripoint( 15, 2, 0 );
+    const pathfinding_settings settings( 0, 100, 1000, false, false, false );
+    const std::vector<tripoint> path = g->m.route( from, to, settings );
+    check_path( path, from, to );
+    const tripoint gap = corner + tripoint( 10, 15, 0 );
+    CHECK( std::find( path.begin(), path.end(), gap ) != path.end() );
+    // The search state left over from the last search must not leak into the next one.
+    CHECK( g->m.route( from, to, settings ) == path );
+
+    // The first request is routed normally, the second one builds the flow field.
+    CHECK( g->m.shared_route( from, to, settings ) == path );
+    const std::vector<tripoint> shared = g->m.shared_route( from, to, settings );
+    check_path( shared, from, to );
+    CHECK( std::find( shared.begin(), shared.end(), gap ) != shared.end() );
+    const tripoint other = corner + tripoint( 3, 14, 0 );
+    check_path( g->m.shared_route( other, to, settings ), other, to );
+    // In the open it walks straight at the target, like map::route.
+    const tripoint open = corner + tripoint( 13, 11, 0 );
+    CHECK( g->m.shared_route( open, to, settings ) == line_to( open, to ) );
+    CHECK( g->m.shared_route( open, to, settings ) == g->m.route( open, to, settings ) );
+
+    g->m.ter_set( gap, t_wall );
+    CHECK( g->m.route( from, to, settings ).empty() );
+    CHECK( g->m.shared_route( from, to, settings ).empty() );
+    CHECK( g->m.shared_route( from, to, settings ).empty() );
+}
+
+static void build_city( const int z )
+{
+    const int size = SEEX * MAPSIZE;
+    clear_area( tripoint( 0, 0, z ), tripoint( size - 1, size - 1, z ) );
+    // Blocks of 8x8 buildings with a door on each side, separated by streets, and some
+    // rubble lying around.
+    for( int x = 0; x < size; x++ ) {
+        for( int y = 0; y < size; y++ ) {
+            const tripoint p( x, y, z );
+            const int bx = x % 12;
+            const int by = y % 12;
+            if( bx >= 2 && bx <= 9 && by >= 2 && by <= 9 && ( bx == 2 || bx == 9 || by == 2 || by == 9 ) ) {
+                g->m.ter_set( p, ( bx == 5 || by == 6 ) ? t_door_c : t_wall );
+            } else if( one_in( 8 ) ) {
+                g->m.furn_set( p, f_rubble );
+            }
+        }
+    }
+}
+
+TEST_CASE( "route_benchmark", "[.]" ) {
+    const int z = g->get_levz();
+    map_restorer restorer( z );
+    const int size = SEEX * MAPSIZE;
+    build_city( z );
+
+    const pathfinding_settings settings( 0, 60, 1000, true, false, false );
+    std::vector<std::pair<tripoint, tripoint>> routes;
+    while( routes.size() < 1000 ) {
+        const tripoint from( rng( 0, size - 1 ), rng( 0, size - 1 ), z );
+        const tripoint to( rng( 0, size - 1 ), rng( 0, size - 1 ), z );
+        if( g->m.passable( from ) && g->m.passable( to ) && rl_dist( from, to ) <= settings.max_dist ) {
+            routes.emplace_back( from, to );
+        }
+    }
+
+    size_t found = 0;
+    size_t length = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( const auto &r : routes ) {
+        const std::vector<tripoint> path = g->m.route( r.first, r.second, settings );
+        found += path.empty() ? 0 : 1;
+        length += path.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "map::route: %zu routes in %ld microseconds, %zu found, %zu tiles total.\n",
+            routes.size(), diff, found, length );
+}
+
+TEST_CASE( "shared_route_benchmark", "[.]" ) {
+    const int z = g->get_levz();
+    map_restorer restorer( z );
+    build_city( z );
+
+    // A horde closing in on a single target.
+    const pathfinding_settings settings( 0, 60, 1000, true, false, false );
+    const tripoint target( SEEX * MAPSIZE / 2, SEEY * MAPSIZE / 2 + 6, z );
+    std::vector<tripoint> horde;
+    while( horde.size() < 200 ) {
+        const tripoint p( target.x + rng( -40, 40 ), target.y + rng( -40, 40 ), z );
+        if( g->m.passable( p ) ) {
+            horde.push_back( p );
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for( const tripoint &p : horde ) {
+        g->m.route( p, target, settings );
+    }
+    auto route_end = std::chrono::high_resolution_clock::now();
+    for( const tripoint &p : horde ) {
+        g->m.shared_route( p, target, settings );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    long route_time = std::chrono::duration_cast<std::chrono::microseconds>( route_end - start ).count();
+    long shared_time = std::chrono::duration_cast<std::chrono::microseconds>( end - route_end ).count();
+    printf( "%zu monsters chasing one target: map::route %ld microseconds, map::shared_route %ld microseconds.\n",
+            horde.size(), route_time, shared_time );
+}
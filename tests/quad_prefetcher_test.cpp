@@ -0,0 +1,64 @@
+#include "catch/catch.hpp"
+
+#include "cata_utility.h"
+#include "filesystem.h"
+#include "quad_prefetcher.h"
+
+#include <chrono>
+#include <thread>
+
+TEST_CASE( "prefetched_quads_are_handed_over_once" ) {
+    const std::string quad = "quad_prefetcher_test";
+    const std::string missing_quad = "quad_prefetcher_test_missing";
+    REQUIRE( write_to_file( quad + ".map", []( std::ostream & fout ) {
+        fout << "[]";
+    }, nullptr ) );
+
+    quad_prefetcher prefetcher;
+    prefetcher.request( quad, true );
+    prefetcher.request( missing_quad, false );
+
+    std::string contents;
+    bool binary = true;
+    // Waits for the worker if it's still reading, otherwise the caller reads it itself.
+    const quad_prefetcher::status status = prefetcher.take( quad, contents, binary );
+    if( status == quad_prefetcher::status::found ) {
+        CHECK( contents == "[]" );
+        CHECK_FALSE( binary );
+    } else {
+        CHECK( status == quad_prefetcher::status::unknown );
+    }
+    CHECK( prefetcher.take( quad, contents, binary ) == quad_prefetcher::status::unknown );
+    CHECK( prefetcher.take( missing_quad, contents, binary ) != quad_prefetcher::status::found );
+
+    // Forgotten results are not handed over.
+    prefetcher.request( quad, false );
+    prefetcher.forget( quad );
+    CHECK( prefetcher.take( quad, contents, binary ) == quad_prefetcher::status::unknown );
+
+    remove_file( quad + ".map" );
+}
+
+TEST_CASE( "prefetched_quads_expire_unless_requested_again" ) {
+    const std::string quad = "quad_prefetcher_test_expire";
+    REQUIRE( write_to_file( quad + ".map", []( std::ostream & fout ) {
+        fout << "[]";
+    }, nullptr ) );
+
+    quad_prefetcher prefetcher;
+    prefetcher.request( quad, false );
+    // Wait for the worker.
+    for( int i = 0; i < 1000 && prefetcher.found_quads().empty(); i++ ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    REQUIRE( prefetcher.found_quads() == std::vector<std::string>( { quad } ) );
+
+    prefetcher.expire( 1 );
+    prefetcher.request( quad, false );
+    prefetcher.expire( 1 );
+    CHECK( prefetcher.found_quads().size() == 1 );
+    prefetcher.expire( 1 );
+    CHECK( prefetcher.found_quads().empty() );
+
+    remove_file( quad + ".map" );
+}
@@ -0,0 +1,184 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "player.h"
+#include "rng.h"
+#include "scent_map.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Same as in scent_map.cpp
+static constexpr int SCENT_RADIUS = 40;
+
+template<typename T>
+using scent_array = std::array<std::array<T, SEEY *MAPSIZE>, SEEX *MAPSIZE>;
+
+struct scent_layout {
+    scent_array<int> scent;
+    scent_array<bool> blocks_scent;
+    scent_array<bool> reduces_scent;
+};
+
+// The diffusion as scent_map::update did it before it was rewritten to be vectorizable.
+static void reference_update( scent_layout &l, const tripoint &center )
+{
+    auto &grscent = l.scent;
+    const auto &blocks_scent = l.blocks_scent;
+    const auto &reduces_scent = l.reduces_scent;
+    std::unique_ptr<scent_array<int>> sum_3_scent_y_ptr( new scent_array<int>() );
+    std::unique_ptr<scent_array<int>> squares_used_y_ptr( new scent_array<int>() );
+    auto &sum_3_scent_y = *sum_3_scent_y_ptr;
+    auto &squares_used_y = *squares_used_y_ptr;
+
+    const int scentmap_minx = center.x - SCENT_RADIUS;
+    const int scentmap_maxx = center.x + SCENT_RADIUS;
+    const int scentmap_miny = center.y - SCENT_RADIUS;
+    const int scentmap_maxy = center.y + SCENT_RADIUS;
+    const int diffusivity = 100;
+
+    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
+            sum_3_scent_y[y][x] = 0;
+            squares_used_y[y][x] = 0;
+            for( int i = y - 1; i <= y + 1; ++i ) {
+                if( !blocks_scent[x][i] ) {
+                    if( reduces_scent[x][i] ) {
+                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
+                        squares_used_y[y][x] += 2;
+                    } else {
+                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
+                        squares_used_y[y][x] += 10;
+                    }
+                }
+            }
+        }
+    }
+
+    for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
+        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
+            auto &scent_here = grscent[x][y];
+            if( !blocks_scent[x][y] ) {
+                int squares_used = squares_used_y[y][x - 1]
+                                   + squares_used_y[y][x]
+                                   + squares_used_y[y][x + 1];
+
+                int this_diffusivity;
+                if( !reduces_scent[x][y] ) {
+                    this_diffusivity = diffusivity;
+                } else {
+                    this_diffusivity = diffusivity / 5;
+                }
+                int temp_scent;
+                temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+                scent_here =
+                    ( temp_scent
+                      + this_diffusivity * ( sum_3_scent_y[y][x - 1]
+                                             + sum_3_scent_y[y][x]
+                                             + sum_3_scent_y[y][x + 1] )
+                    ) / ( 1000 * 10 );
+            } else {
+                scent_here = 0;
+            }
+        }
+    }
+}
+
+// Random walls, REDUCE_SCENT doors and scent around the center, remembers the old terrain.
+static std::vector<ter_id> randomize( scent_map &sm, const tripoint &center )
+{
+    std::vector<ter_id> old_terrain;
+    for( int x = center.x - SCENT_RADIUS - 1; x <= center.x + SCENT_RADIUS + 1; x++ ) {
+        for( int y = center.y - SCENT_RADIUS - 1; y <= center.y + SCENT_RADIUS + 1; y++ ) {
+            const tripoint p( x, y, center.z );
+            old_terrain.push_back( g->m.ter( p ) );
+            g->m.ter_set( p, one_in( 5 ) ? t_wall : ( one_in( 5 ) ? t_door_b : t_floor ) );
+            sm.set( p, rng( 0, 1000 ) );
+        }
+    }
+    return old_terrain;
+}
+
+static void restore( const std::vector<ter_id> &old_terrain, const tripoint &center )
+{
+    size_t i = 0;
+    for( int x = center.x - SCENT_RADIUS - 1; x <= center.x + SCENT_RADIUS + 1; x++ ) {
+        for( int y = center.y - SCENT_RADIUS - 1; y <= center.y + SCENT_RADIUS + 1; y++ ) {
+            g->m.ter_set( tripoint( x, y, center.z ), old_terrain[i++] );
+        }
+    }
+}
+
+static void take_layout( const scent_map &sm, scent_layout &l, const tripoint &center )
+{
+    for( int x = 0; x < SEEX * MAPSIZE; x++ ) {
+        for( int y = 0; y < SEEY * MAPSIZE; y++ ) {
+            l.scent[x][y] = sm.get( tripoint( x, y, center.z ) );
+        }
+    }
+    g->m.scent_blockers( l.blocks_scent, l.reduces_scent,
+                         center.x - SCENT_RADIUS - 1, center.y - SCENT_RADIUS - 1,
+                         center.x + SCENT_RADIUS + 1, center.y + SCENT_RADIUS + 1 );
+}
+
+TEST_CASE( "scent_diffusion_matches_reference" ) {
+    // Not the player's position, other tests move the player around.
+    const tripoint center( SEEX * MAPSIZE / 2, SEEY * MAPSIZE / 2, g->get_levz() );
+    std::unique_ptr<scent_layout> expected( new scent_layout() );
+    for( int i = 0; i < 3; i++ ) {
+        scent_map sm( *g );
+        sm.reset();
+        const std::vector<ter_id> old_terrain = randomize( sm, center );
+        take_layout( sm, *expected, center );
+
+        // Twice, so the second step diffuses scent that has already been diffused.
+        for( int step = 0; step < 2; step++ ) {
+            sm.update( center, g->m );
+            reference_update( *expected, center );
+        }
+        restore( old_terrain, center );
+
+        int mismatches = 0;
+        for( int x = 0; x < SEEX * MAPSIZE; x++ ) {
+            for( int y = 0; y < SEEY * MAPSIZE; y++ ) {
+                if( sm.get( tripoint( x, y, center.z ) ) != std::max( 0, expected->scent[x][y] ) ) {
+                    mismatches++;
+                }
+            }
+        }
+        CHECK( mismatches == 0 );
+    }
+}
+
+TEST_CASE( "scent_diffusion_benchmark", "[.]" ) {
+    const tripoint center( SEEX * MAPSIZE / 2, SEEY * MAPSIZE / 2, g->get_levz() );
+    const int iterations = 1000;
+    const long cells = ( 2 * SCENT_RADIUS + 1 ) * ( 2 * SCENT_RADIUS + 1 ) * long( iterations );
+    std::unique_ptr<scent_layout> layout( new scent_layout() );
+    scent_map sm( *g );
+    sm.reset();
+    const std::vector<ter_id> old_terrain = randomize( sm, center );
+    take_layout( sm, *layout, center );
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        reference_update( *layout, center );
+    }
+    auto reference_end = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        sm.update( center, g->m );
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    restore( old_terrain, center );
+
+    // scent_map::update includes looking up the scent blockers on the map.
+    const double reference_time = std::chrono::duration<double>( reference_end - start ).count();
+    const double update_time = std::chrono::duration<double>( end - reference_end ).count();
+    printf( "Scent diffusion: reference %.0f cells/second, scent_map::update %.0f cells/second.\n",
+            cells / reference_time, cells / update_time );
+}
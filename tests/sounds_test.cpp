@@ -0,0 +1,66 @@
+#include "catch/catch.hpp"
+
+#include "creature_tracker.h"
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "mapdata.h"
+#include "monster.h"
+#include "options.h"
+#include "sounds.h"
+
+#include <vector>
+
+// The monsters process_sounds used to notify: all of them within twice the volume.
+static std::vector<std::pair<int, int>> all_in_range( const tripoint &source, const int volume )
+{
+    std::vector<std::pair<int, int>> result;
+    for( size_t i = 0; i < g->num_zombies(); i++ ) {
+        if( volume * 2 > rl_dist( source, g->zombie( i ).pos() ) ) {
+            result.emplace_back( i, volume );
+        }
+    }
+    return result;
+}
+
+TEST_CASE( "sounds_reach_the_same_monsters_as_before" ) {
+    g->clear_zombies();
+    const int z = g->get_levz();
+    for( int i = 0; i < 200; i++ ) {
+        monster mon( mtype_id( "mon_zombie" ), tripoint( -10 + ( i % 20 ) * 7, -10 + ( i / 20 ) * 13, z ) );
+        g->critter_tracker->add( mon );
+    }
+    REQUIRE_FALSE( get_option<bool>( "SOUNDS_MUFFLED_BY_WALLS" ) );
+
+    for( const tripoint &source : {
+             tripoint( 60, 60, z ), tripoint( 3, 100, z ), tripoint( 130, 5, z ), tripoint( 60, 60, z + 1 )
+         } ) {
+        for( const int volume : { -5, 0, 1, 5, 12, 30, 80, 200 } ) {
+            CHECK( sounds::monster_listeners( source, volume ) == all_in_range( source, volume ) );
+        }
+    }
+    g->clear_zombies();
+}
+
+TEST_CASE( "walls_muffle_sounds" ) {
+    g->clear_zombies();
+    const int z = g->get_levz();
+    const tripoint source( 60, 60, z );
+    const tripoint behind_wall( 70, 60, z );
+    const tripoint wall( 65, 60, z );
+    const ter_id old_wall = g->m.ter( wall );
+    g->m.ter_set( wall, t_wall );
+    g->m.build_map_cache( z );
+    monster mon( mtype_id( "mon_zombie" ), behind_wall );
+    g->critter_tracker->add( mon );
+
+    get_options().get_option( "SOUNDS_MUFFLED_BY_WALLS" ).setValue( "true" );
+    const auto muffled = sounds::monster_listeners( source, 40 );
+    get_options().get_option( "SOUNDS_MUFFLED_BY_WALLS" ).setValue( "false" );
+    REQUIRE( muffled.size() == 1 );
+    CHECK( muffled.front().second < 40 );
+
+    g->m.ter_set( wall, old_wall );
+    g->m.build_map_cache( z );
+    g->clear_zombies();
+}
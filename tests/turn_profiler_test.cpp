@@ -0,0 +1,42 @@
+#include "catch/catch.hpp"
+
+#include "turn_profiler.h"
+
+using turn_profiler::stage;
+
+TEST_CASE( "turn_profiler_records_stages" ) {
+    turn_profiler::set_enabled( true );
+    turn_profiler::clear();
+
+    for( int turn = 0; turn < 10; ++turn ) {
+        turn_profiler::scoped_timer outer( stage::monmove );
+        for( int i = 0; i < 3; ++i ) {
+            turn_profiler::scoped_timer inner( stage::monster_plan );
+        }
+    }
+    // Timers above were committed into a single turn, nothing is in the history before end_turn.
+    CHECK( turn_profiler::recorded_turns() == 0 );
+    turn_profiler::end_turn();
+    turn_profiler::end_turn();
+
+    CHECK( turn_profiler::recorded_turns() == 2 );
+    const auto plan = turn_profiler::summarize( stage::monster_plan );
+    CHECK( plan.calls_per_turn == Approx( 15.0 ) );
+    CHECK( plan.p50_ms <= plan.p99_ms );
+    CHECK( plan.p99_ms <= plan.max_ms );
+    CHECK( turn_profiler::summarize( stage::route ).calls_per_turn == Approx( 0.0 ) );
+
+    // Leaving the scope of a turn ends it, like an early return from game::do_turn.
+    {
+        turn_profiler::turn_scope turn;
+        turn_profiler::scoped_timer timer( stage::route );
+    }
+    CHECK( turn_profiler::recorded_turns() == 3 );
+
+    turn_profiler::set_enabled( false );
+    {
+        turn_profiler::scoped_timer ignored( stage::route );
+    }
+    turn_profiler::end_turn();
+    CHECK( turn_profiler::recorded_turns() == 3 );
+}
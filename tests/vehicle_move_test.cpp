@@ -0,0 +1,186 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+#include "player.h"
+#include "vehicle.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <map>
+#include <set>
+#include <vector>
+
+static void clear_vehicles()
+{
+    for( auto &v : g->m.get_vehicles() ) {
+        g->m.destroy_vehicle( v.v );
+    }
+}
+
+// Flat pavement without furniture, so the vehicles can move freely.
+static std::vector<std::pair<tripoint, ter_id>> pave( const tripoint &from, const tripoint &to )
+{
+    std::vector<std::pair<tripoint, ter_id>> old_ter;
+    for( const tripoint &p : g->m.points_in_rectangle( from, to ) ) {
+        old_ter.emplace_back( p, g->m.ter( p ) );
+        g->m.ter_set( p, ter_id( "t_pavement" ) );
+        g->m.furn_set( p, f_null );
+    }
+    return old_ter;
+}
+
+static void restore( const std::vector<std::pair<tripoint, ter_id>> &old_ter )
+{
+    for( const auto &e : old_ter ) {
+        g->m.ter_set( e.first, e.second );
+    }
+}
+
+TEST_CASE( "only_moving_vehicles_move" ) {
+    clear_vehicles();
+    const int z = g->get_levz();
+    const tripoint road_start( SEEX * 2, SEEY * 2, z );
+    const auto old_ter = pave( road_start, road_start + tripoint( 40, 30, 0 ) );
+
+    vehicle *moving = g->m.add_vehicle( vproto_id( "car" ), road_start + tripoint( 5, 5, 0 ), 0, 0, 0 );
+    vehicle *parked = g->m.add_vehicle( vproto_id( "car" ), road_start + tripoint( 5, 20, 0 ), 0, 0, 0 );
+    REQUIRE( moving != nullptr );
+    REQUIRE( parked != nullptr );
+    moving->velocity = 2000;
+    const tripoint moving_pos = moving->global_pos3();
+    const tripoint parked_pos = parked->global_pos3();
+
+    g->m.vehmove();
+
+    CHECK( moving->global_pos3() != moving_pos );
+    CHECK( moving->of_turn < 1.0f );
+    CHECK( parked->global_pos3() == parked_pos );
+    CHECK( parked->of_turn == 0.0f );
+
+    clear_vehicles();
+    restore( old_ter );
+}
+
+TEST_CASE( "vehicle_move_benchmark", "[.]" ) {
+    clear_vehicles();
+    const int z = g->get_levz();
+    const tripoint lot_start( SEEX * 2, SEEY * 2, z );
+    const auto old_ter = pave( lot_start, tripoint( SEEX * 9, SEEY * 9, z ) );
+    // 50 vehicles, every fifth of them moving.
+    for( int i = 0; i < 50; i++ ) {
+        const tripoint p = lot_start + tripoint( 4 + ( i % 10 ) * 8, 4 + ( i / 10 ) * 12, 0 );
+        if( rl_dist( p, g->u.pos() ) < 8 ) {
+            continue;
+        }
+        vehicle *veh = g->m.add_vehicle( vproto_id( "car" ), p, 90, 0, 0 );
+        REQUIRE( veh != nullptr );
+        if( i % 5 == 0 ) {
+            veh->velocity = 1500;
+        }
+    }
+
+    const int turns = 10;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < turns; i++ ) {
+        g->m.vehmove();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "map::vehmove: %zu vehicles, %d turns in %ld microseconds.\n",
+            g->m.get_vehicles().size(), turns, diff );
+
+    clear_vehicles();
+    restore( old_ter );
+}
+
+static void check_veh_at( const vehicle &veh )
+{
+    for( size_t p = 0; p < veh.parts.size(); p++ ) {
+        int part = -1;
+        REQUIRE( g->m.veh_at( veh.global_part_pos3( p ), part ) == &veh );
+        CHECK( veh.parts[ part ].mount == veh.parts[ p ].mount );
+    }
+}
+
+TEST_CASE( "veh_at_follows_moving_vehicles" ) {
+    clear_vehicles();
+    const int z = g->get_levz();
+    const tripoint road_start( SEEX * 2, SEEY * 2, z );
+    const auto old_ter = pave( road_start, road_start + tripoint( 40, 30, 0 ) );
+
+    vehicle *moving = g->m.add_vehicle( vproto_id( "car" ), road_start + tripoint( 5, 5, 0 ), 0, 0, 0 );
+    vehicle *parked = g->m.add_vehicle( vproto_id( "car" ), road_start + tripoint( 5, 20, 0 ), 0, 0, 0 );
+    REQUIRE( moving != nullptr );
+    REQUIRE( parked != nullptr );
+    const tripoint old_pos = moving->global_pos3();
+    const std::set<tripoint> old_points = moving->get_points( true );
+    moving->velocity = 2000;
+    g->m.vehmove();
+    REQUIRE( moving->global_pos3() != old_pos );
+
+    check_veh_at( *moving );
+    check_veh_at( *parked );
+    for( const tripoint &p : old_points ) {
+        if( !moving->get_points( true ).count( p ) ) {
+            CHECK( g->m.veh_at( p ) == nullptr );
+        }
+    }
+
+    g->m.destroy_vehicle( moving );
+    check_veh_at( *parked );
+    for( const tripoint &p : old_points ) {
+        CHECK( g->m.veh_at( p ) == nullptr );
+    }
+
+    clear_vehicles();
+    restore( old_ter );
+}
+
+TEST_CASE( "veh_at_benchmark", "[.]" ) {
+    clear_vehicles();
+    const int z = g->get_levz();
+    const tripoint road_start( SEEX * 2, SEEY * 2, z );
+    const auto old_ter = pave( road_start, tripoint( SEEX * ( MAPSIZE - 2 ), SEEY * 3, z ) );
+    vehicle *bus = g->m.add_vehicle( vproto_id( "schoolbus" ), road_start + tripoint( 10, 5, 0 ), 0, 0, 0 );
+    REQUIRE( bus != nullptr );
+    bus->velocity = 1000;
+
+    const int turns = 20;
+    long map_time = 0;
+    long grid_time = 0;
+    size_t lookups = 0;
+    size_t found = 0;
+    for( int i = 0; i < turns; i++ ) {
+        g->m.vehmove();
+        // The sorted map the vehicle cache used to be.
+        std::map<tripoint, std::pair<vehicle *, int>> cached_parts;
+        for( size_t p = 0; p < bus->parts.size(); p++ ) {
+            cached_parts.emplace( bus->global_part_pos3( p ), std::make_pair( bus, static_cast<int>( p ) ) );
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        for( const tripoint &p : g->m.points_in_rectangle( tripoint( 0, 0, z ),
+                tripoint( SEEX * MAPSIZE - 1, SEEY * MAPSIZE - 1, z ) ) ) {
+            if( g->m.get_cache_ref( z ).veh_exists_at[p.x][p.y] ) {
+                found += cached_parts.find( p ) != cached_parts.end();
+            }
+        }
+        auto map_end = std::chrono::high_resolution_clock::now();
+        for( const tripoint &p : g->m.points_in_rectangle( tripoint( 0, 0, z ),
+                tripoint( SEEX * MAPSIZE - 1, SEEY * MAPSIZE - 1, z ) ) ) {
+            found += g->m.veh_at( p ) != nullptr;
+            lookups++;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        map_time += std::chrono::duration_cast<std::chrono::microseconds>( map_end - start ).count();
+        grid_time += std::chrono::duration_cast<std::chrono::microseconds>( end - map_end ).count();
+    }
+    printf( "map::veh_at while driving a bus, %zu lookups: sorted map %ld microseconds, grid %ld microseconds (%zu found).\n",
+            lookups, map_time, grid_time, found );
+
+    clear_vehicles();
+    restore( old_ter );
+}
@@ -0,0 +1,88 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+#include "veh_type.h"
+#include "vehicle.h"
+
+#include <string>
+#include <vector>
+
+// What all_parts_with_feature used to scan for, optionally leaving out the removed parts.
+template<typename T>
+static std::vector<int> scan_parts( const vehicle &veh, const T &flag, bool unbroken,
+                                    bool removed )
+{
+    std::vector<int> res;
+    for( size_t p = 0; p < veh.parts.size(); p++ ) {
+        if( ( removed || !veh.parts[ p ].removed ) && veh.part_info( p ).has_flag( flag ) &&
+            ( !unbroken || !veh.parts[ p ].is_broken() ) ) {
+            res.push_back( p );
+        }
+    }
+    return res;
+}
+
+static void check_index( const vehicle &veh )
+{
+    for( int f = 0; f < NUM_VPFLAGS; f++ ) {
+        const vpart_bitflags flag = static_cast<vpart_bitflags>( f );
+        CHECK( veh.parts_with_feature( flag ) == scan_parts( veh, flag, false, true ) );
+        CHECK( veh.all_parts_with_feature( flag, true ) == scan_parts( veh, flag, true, true ) );
+    }
+    for( const std::string flag : {
+             "SEAT", "SEATBELT", "CARGO", "ENGINE", "WINDOW", "STEREO", "NOT_A_FLAG"
+         } ) {
+        CHECK( veh.parts_with_feature( flag ) == scan_parts( veh, flag, false, true ) );
+        CHECK( veh.all_parts_with_feature( flag, true ) == scan_parts( veh, flag, true, true ) );
+        CHECK( veh.has_part( flag ) == !scan_parts( veh, flag, true, false ).empty() );
+        CHECK( veh.get_parts( flag ).size() == scan_parts( veh, flag, true, false ).size() );
+    }
+}
+
+TEST_CASE( "vehicle_part_index_follows_part_changes" ) {
+    const tripoint pos( SEEX * 3, SEEY * 3, g->get_levz() );
+    // Flat ground without vehicles or furniture, so the car can be placed.
+    for( auto &v : g->m.get_vehicles() ) {
+        g->m.destroy_vehicle( v.v );
+    }
+    std::vector<std::pair<tripoint, ter_id>> old_ter;
+    for( const tripoint &p : g->m.points_in_radius( pos, 6 ) ) {
+        old_ter.emplace_back( p, g->m.ter( p ) );
+        g->m.ter_set( p, ter_id( "t_pavement" ) );
+        g->m.furn_set( p, f_null );
+    }
+    vehicle *veh = g->m.add_vehicle( vproto_id( "car" ), pos, 0, 0, 0 );
+    REQUIRE( veh != nullptr );
+    check_index( *veh );
+
+    // Installing a part.
+    const point mount = veh->parts[ 0 ].mount;
+    REQUIRE( veh->install_part( mount.x, mount.y, vpart_id( "trunk" ), true ) >= 0 );
+    check_index( *veh );
+
+    // Breaking a part keeps it in the index, but not in the unbroken lists.
+    const std::vector<int> cargo = veh->parts_with_feature( VPFLAG_CARGO );
+    REQUIRE_FALSE( cargo.empty() );
+    veh->set_hp( veh->parts[ cargo.back() ], 0 );
+    CHECK( veh->parts_with_feature( VPFLAG_CARGO ) == cargo );
+    check_index( *veh );
+
+    // Removing a seat removes its seatbelt as well.
+    const std::vector<int> seats = veh->parts_with_feature( "SEAT" );
+    REQUIRE_FALSE( seats.empty() );
+    veh->remove_part( seats.front() );
+    check_index( *veh );
+
+    // Removed parts are dropped from the vector, moving the other parts.
+    veh->part_removal_cleanup();
+    check_index( *veh );
+    CHECK( veh->parts_with_feature( "SEAT" ).size() == seats.size() - 1 );
+
+    g->m.destroy_vehicle( veh );
+    for( const auto &e : old_ter ) {
+        g->m.ter_set( e.first, e.second );
+    }
+}
@@ -0,0 +1,149 @@
+#include "catch/catch.hpp"
+
+#include "calendar.h"
+#include "game.h"
+#include "item.h"
+#include "map.h"
+#include "player.h"
+#include "weather.h"
+#include "weather_gen.h"
+
+#include "stdio.h"
+#include <chrono>
+#include <vector>
+
+int get_hourly_rotpoints_at_temp( int temp );
+
+// The hour by hour loop get_rot_since used to do.
+static int rot_by_sampling( const int startturn, const int endturn, const tripoint &location )
+{
+    int ret = 0;
+    const auto &wgen = g->get_cur_weather_gen();
+    for( calendar i( startturn ); i.get_turn() < endturn; i += HOURS( 1 ) ) {
+        w_point w = wgen.get_weather( location, i, g->get_seed() );
+        ret += std::min( HOURS( 1 ), endturn - i.get_turn() ) * get_hourly_rotpoints_at_temp( w.temperature ) / HOURS( 1 );
+    }
+    return ret;
+}
+
+// Center of the overmap terrain the player is in, where the timeline samples the weather.
+static tripoint region_center()
+{
+    const tripoint pos = g->m.getabs( g->u.pos() );
+    const int omt_x = pos.x / ( SEEX * 2 );
+    const int omt_y = pos.y / ( SEEY * 2 );
+    return tripoint( omt_x * SEEX * 2 + SEEX, omt_y * SEEY * 2 + SEEY, pos.z );
+}
+
+TEST_CASE( "rot_catch_up_matches_hourly_samples" ) {
+    const tripoint location = region_center();
+    const int start = HOURS( 24 * 100 + 5 );
+    for( const int length : {
+             HOURS( 1 ) + 1, HOURS( 3 ), HOURS( 7 ) + 599, DAYS( 2 ) + 17, DAYS( 91 )
+         } ) {
+        CHECK( get_rot_since( start, start + length, location ) ==
+               rot_by_sampling( start, start + length, location ) );
+    }
+    // Short intervals are not changed, they sample their start.
+    CHECK( get_rot_since( start + 17, start + 317, location ) ==
+           rot_by_sampling( start + 17, start + 317, location ) );
+    // An earlier start extends the timeline backwards.
+    CHECK( get_rot_since( start - DAYS( 3 ), start + DAYS( 1 ), location ) ==
+           rot_by_sampling( start - DAYS( 3 ), start + DAYS( 1 ), location ) );
+}
+
+// What sum_conditions does with a sample of the weather.
+static void add_sample( weather_sum &data, const calendar &turn, const int tick_size,
+                        const tripoint &location )
+{
+    const auto &wgen = g->get_cur_weather_gen();
+    const weather_type wtype = wgen.get_weather_conditions( location, turn, g->get_seed() );
+    if( wtype == WEATHER_DRIZZLE ) {
+        data.rain_amount += 4 * tick_size;
+    } else if( wtype == WEATHER_RAINY || wtype == WEATHER_THUNDER || wtype == WEATHER_LIGHTNING ) {
+        data.rain_amount += 8 * tick_size;
+    } else if( wtype == WEATHER_ACID_DRIZZLE ) {
+        data.acid_amount += 4 * tick_size;
+    } else if( wtype == WEATHER_ACID_RAIN ) {
+        data.acid_amount += 8 * tick_size;
+    }
+    const float tick_sunlight = turn.sunlight() - weather_data( wtype ).light_modifier;
+    data.sunlight += std::max<float>( 0.0f, tick_size * tick_sunlight );
+}
+
+TEST_CASE( "weather_sums_up_to_a_week_are_sampled_every_minute" ) {
+    const tripoint location = g->m.getabs( g->u.pos() );
+    const int start = HOURS( 24 * 150 ) + MINUTES( 23 ) + 4;
+    for( const int length : {
+             HOURS( 1 ) + 1, HOURS( 5 ) + 7, DAYS( 7 )
+         } ) {
+        weather_sum expected;
+        for( calendar turn( start ); turn < start + length; turn += MINUTES( 1 ) ) {
+            add_sample( expected, turn, MINUTES( 1 ), location );
+        }
+        const weather_sum sum = sum_conditions( start, start + length, location );
+        CHECK( sum.rain_amount == expected.rain_amount );
+        CHECK( sum.acid_amount == expected.acid_amount );
+        CHECK( sum.sunlight == Approx( expected.sunlight ) );
+    }
+}
+
+TEST_CASE( "weather_sums_match_hourly_samples" ) {
+    const tripoint location = region_center();
+    // Both ends are in the middle of an hour, those partial hours are sampled every minute.
+    const int start = HOURS( 24 * 200 ) + MINUTES( 17 );
+    const int end = start + DAYS( 30 ) + MINUTES( 10 );
+    const int first = HOURS( 24 * 200 + 1 );
+    const int last = end - end % HOURS( 1 );
+    // Same as sum_conditions did for more than a week, but with whole hours.
+    weather_sum expected;
+    for( calendar turn( start ); turn < first; turn += MINUTES( 1 ) ) {
+        add_sample( expected, turn, MINUTES( 1 ), location );
+    }
+    for( calendar turn( first ); turn < last; turn += HOURS( 1 ) ) {
+        add_sample( expected, turn, HOURS( 1 ), location );
+    }
+    for( calendar turn( last ); turn < end; turn += MINUTES( 1 ) ) {
+        add_sample( expected, turn, MINUTES( 1 ), location );
+    }
+    const weather_sum sum = sum_conditions( start, end, location );
+    CHECK( sum.rain_amount == expected.rain_amount );
+    CHECK( sum.acid_amount == expected.acid_amount );
+    // The timeline samples the sunlight every minute instead of every hour.
+    CHECK( sum.sunlight == Approx( expected.sunlight ).epsilon( 0.05 ) );
+}
+
+TEST_CASE( "rot_catch_up_benchmark", "[.]" ) {
+    // A submap full of food, looked at again after 90 days.
+    const int before = calendar::turn;
+    const tripoint corner = g->m.getabs( tripoint( SEEX * 4, SEEY * 4, g->get_levz() ) );
+    std::vector<std::pair<item, tripoint>> food;
+    for( int x = 0; x < SEEX; x++ ) {
+        for( int y = 0; y < SEEY; y++ ) {
+            for( int i = 0; i < 5; i++ ) {
+                item it( "meat", before );
+                food.emplace_back( it, corner + tripoint( x, y, 0 ) );
+            }
+        }
+    }
+    calendar::turn = before + DAYS( 90 );
+
+    auto start = std::chrono::high_resolution_clock::now();
+    int sampled = 0;
+    for( auto &e : food ) {
+        sampled += rot_by_sampling( before, calendar::turn, e.second );
+    }
+    auto sampled_end = std::chrono::high_resolution_clock::now();
+    int rotten = 0;
+    for( auto &e : food ) {
+        e.first.calc_rot( e.second );
+        rotten += e.first.has_rotten_away();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    calendar::turn = before;
+
+    long sampled_time = std::chrono::duration_cast<std::chrono::microseconds>( sampled_end - start ).count();
+    long timeline_time = std::chrono::duration_cast<std::chrono::microseconds>( end - sampled_end ).count();
+    printf( "Rot of %zu items after 90 days: hourly samples %ld microseconds (%d rot), timeline %ld microseconds (%d rotten away).\n",
+            food.size(), sampled_time, sampled, timeline_time, rotten );
+}